@@ -0,0 +1,58 @@
+/**
+ * @file AllocHook.cpp
+ * @brief Replacement global operator new/delete that feeds MemoryStats.
+ *
+ * Linked into the CLI and benchmark executables only, never into the
+ * seamcarve library, so embedding applications keep their own allocator.
+ * Each block carries a header with its size so that unsized deletes can
+ * update the live byte count.
+ */
+
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include "MemoryStats.hpp"
+
+namespace {
+
+// keeps the returned pointer aligned for any fundamental type
+constexpr std::size_t kHeader = alignof(std::max_align_t) < 16 ? 16 : alignof(std::max_align_t);
+
+[[maybe_unused]] const bool registered = (MemoryStats::setHooked(), true);
+
+void* allocate(std::size_t size) {
+    void* raw = std::malloc(size + kHeader);
+    if (!raw) return nullptr;
+    *static_cast<std::size_t*>(raw) = size;
+    MemoryStats::recordAlloc(size);
+    return static_cast<char*>(raw) + kHeader;
+}
+
+void deallocate(void* p) {
+    if (!p) return;
+    void* raw = static_cast<char*>(p) - kHeader;
+    MemoryStats::recordFree(*static_cast<std::size_t*>(raw));
+    std::free(raw);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* p = allocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* p = allocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* p) noexcept { deallocate(p); }
+void operator delete[](void* p) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { deallocate(p); }
@@ -0,0 +1,128 @@
+#include <string>
+#include <memory>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <iostream>
+#include <stdexcept>
+#include <cctype>
+#include "FrameSequence.hpp"
+
+/**
+ * @brief Split pattern around its frame number conversion.
+ * @throws runtime_error unless pattern holds exactly one %d or %0Nd.
+ */
+FramePattern::FramePattern(const std::string& pattern) {
+    auto pos = pattern.find('%');
+    if (pos == std::string::npos) throw std::runtime_error("No %d in frame pattern: " + pattern);
+    std::size_t i = pos + 1;
+    if (i < pattern.size() && pattern[i] == '0') ++i;
+    while (i < pattern.size() && std::isdigit((unsigned char)pattern[i]))
+        digits_ = digits_ * 10 + (pattern[i++] - '0');
+    if (i >= pattern.size() || pattern[i] != 'd' || digits_ > 18
+        || pattern.find('%', i) != std::string::npos)
+        throw std::runtime_error("Frame pattern needs exactly one %d or %0Nd: " + pattern);
+    prefix_ = pattern.substr(0, pos);
+    suffix_ = pattern.substr(i + 1);
+}
+
+/** @brief True if name contains a '%' and should be parsed as a pattern. */
+bool FramePattern::isPattern(const std::string& name) {
+    return name.find('%') != std::string::npos;
+}
+
+/** @brief File name of frame n. */
+std::string FramePattern::name(long long n) const {
+    std::string number = std::to_string(n);
+    if (int(number.size()) < digits_) number.insert(0, digits_ - number.size(), '0');
+    return prefix_ + number + suffix_;
+}
+
+/**
+ * @brief Open a numbered sequence or a concatenated stream, inflating it if
+ *        it starts with the gzip magic.
+ * @throws runtime_error if the stream cannot be opened.
+ */
+FrameReader::FrameReader(const std::string& source, long long first) : next_(first) {
+    if (FramePattern::isPattern(source)) {
+        pattern_ = std::make_unique<FramePattern>(source);
+        return;
+    }
+    if (source == "-") {
+        stream_ = &std::cin;
+    } else {
+        file_.open(source, std::ios::binary);
+        if (!file_) throw std::runtime_error("Cannot open input file");
+        stream_ = &file_;
+    }
+    if (InflateBuf::detect(*stream_)) {
+        inflate_ = std::make_unique<InflateBuf>(*stream_);
+        gzip_ = std::make_unique<std::istream>(inflate_.get());
+        gzip_->exceptions(std::ios::badbit);   // corrupt data reports its own error
+        stream_ = gzip_.get();
+    }
+}
+
+/**
+ * @brief Next frame, or nullptr after the last one.
+ * @throws runtime_error on format error.
+ */
+std::unique_ptr<Image> FrameReader::next() {
+    if (pattern_) {
+        const std::string name = pattern_->name(next_);
+        if (!std::ifstream(name)) return nullptr;
+        ++next_;
+        return std::make_unique<Image>(name);
+    }
+    *stream_ >> std::ws;
+    if (stream_->peek() == std::char_traits<char>::eof()) return nullptr;
+    return std::make_unique<Image>(*stream_);
+}
+
+/**
+ * @brief Create the output stream, or remember the pattern.
+ * @throws runtime_error if the stream cannot be opened.
+ */
+FrameWriter::FrameWriter(const std::string& target, long long first) : next_(first) {
+    if (FramePattern::isPattern(target)) {
+        pattern_ = std::make_unique<FramePattern>(target);
+        return;
+    }
+    if (target == "-") {
+        stream_ = &std::cout;
+        return;
+    }
+    file_.open(target, std::ios::binary);
+    if (!file_) throw std::runtime_error("Cannot open output file");
+    stream_ = &file_;
+    if (isGzipName(target)) {
+        deflate_ = std::make_unique<DeflateBuf>(file_);
+        gzip_ = std::make_unique<std::ostream>(deflate_.get());
+        stream_ = gzip_.get();
+    }
+}
+
+/**
+ * @brief Append one frame.
+ * @throws runtime_error on I/O error.
+ */
+void FrameWriter::write(const Image& frame) {
+    if (pattern_) {
+        frame.write(pattern_->name(next_++));
+        return;
+    }
+    frame.write(*stream_);
+    if (stream_ == &std::cout) stream_->flush();
+    if (!*stream_) throw std::runtime_error("Cannot write output file");
+}
+
+/**
+ * @brief Write the final gzip block and trailer.
+ * @throws runtime_error on I/O error.
+ */
+void FrameWriter::finish() {
+    if (!deflate_) return;
+    stream_->flush();
+    deflate_->finish();
+    if (!file_.flush()) throw std::runtime_error("Cannot write output file");
+}
@@ -0,0 +1,103 @@
+#include <string>
+#include <memory>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include "Image.hpp"
+#include "Gzip.hpp"
+
+#ifndef FRAMESEQUENCE_HPP
+#define FRAMESEQUENCE_HPP
+
+/**
+ * @class FramePattern
+ * @brief File name pattern with one printf-style frame number, e.g. frame_%04d.ppm.
+ */
+class FramePattern {
+private:
+    std::string prefix_, suffix_;
+    int digits_ = 0;   // minimum width, zero padded
+
+public:
+    /**
+     * @throws runtime_error unless pattern holds exactly one %d or %0Nd.
+     */
+    explicit FramePattern(const std::string& pattern);
+
+    /** @brief True if name contains a '%' and should be parsed as a pattern. */
+    static bool isPattern(const std::string& name);
+
+    /** @brief File name of frame n. */
+    std::string name(long long n) const;
+};
+
+/**
+ * @class FrameReader
+ * @brief Reads frames one at a time from numbered files or from one stream of
+ *        concatenated images (a file or stdin, gzip compressed or not). Only
+ *        the current frame is held in memory.
+ */
+class FrameReader {
+private:
+    std::unique_ptr<FramePattern> pattern_;
+    long long next_;
+    std::ifstream file_;
+    std::unique_ptr<InflateBuf> inflate_;
+    std::unique_ptr<std::istream> gzip_;
+    std::istream* stream_ = nullptr;
+
+public:
+    /**
+     * @param source Frame pattern (see FramePattern), path of a concatenated
+     *        stream, or "-" for stdin.
+     * @param first Number of the first frame of a pattern.
+     * @throws runtime_error if the stream cannot be opened.
+     */
+    FrameReader(const std::string& source, long long first);
+
+    /**
+     * @brief Next frame, or nullptr after the last one (the first missing
+     *        numbered file, or the end of the stream).
+     * @throws runtime_error on format error.
+     */
+    std::unique_ptr<Image> next();
+};
+
+/**
+ * @class FrameWriter
+ * @brief Writes frames to numbered files or concatenated into one stream (a
+ *        file, gzip compressed if its name ends in ".gz", or stdout).
+ */
+class FrameWriter {
+private:
+    std::unique_ptr<FramePattern> pattern_;
+    long long next_;
+    std::ofstream file_;
+    std::unique_ptr<DeflateBuf> deflate_;
+    std::unique_ptr<std::ostream> gzip_;
+    std::ostream* stream_ = nullptr;
+
+public:
+    /**
+     * @param target Frame pattern (see FramePattern), path of a concatenated
+     *        stream, or "-" for stdout.
+     * @param first Number of the first frame of a pattern.
+     * @throws runtime_error if the stream cannot be opened.
+     */
+    FrameWriter(const std::string& target, long long first);
+
+    /**
+     * @brief Append one frame. Frames written to stdout are flushed at once,
+     *        so a pipeline downstream gets each as soon as it is carved.
+     * @throws runtime_error on I/O error.
+     */
+    void write(const Image& frame);
+
+    /**
+     * @brief Complete a gzip compressed stream; no-op otherwise.
+     * @throws runtime_error on I/O error.
+     */
+    void finish();
+};
+
+#endif // !FRAMESEQUENCE_HPP
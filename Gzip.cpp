@@ -0,0 +1,696 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include "Gzip.hpp"
+
+namespace {
+
+const std::size_t kWindow = 32768;      // deflate history
+const std::size_t kStep = 65536;        // output per underflow, input per block
+const std::size_t kMaxMatch = 258;
+const std::size_t kMaxStored = 65535;
+const std::size_t kInputBlock = 65536;
+const int kHashBits = 15;
+
+const std::uint16_t kLenBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                     35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const std::uint8_t kLenExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                     3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const std::uint16_t kDistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                      257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                      8193, 12289, 16385, 24577 };
+const std::uint8_t kDistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                      7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+// order in which the code length code lengths are stored
+const std::uint8_t kCodeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2,
+                                            14, 1, 15 };
+
+/**
+ * @brief CRC-32 tables for slicing by eight bytes.
+ */
+struct CrcTables {
+    std::uint32_t t[8][256];
+    CrcTables() {
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            t[0][i] = c;
+        }
+        for (int k = 1; k < 8; ++k)
+            for (int i = 0; i < 256; ++i) t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+    }
+};
+
+std::uint32_t crc32(std::uint32_t crc, const unsigned char* p, std::size_t n) {
+    static const CrcTables tables;
+    const auto& t = tables.t;
+    crc = ~crc;
+    for (; n >= 8; p += 8, n -= 8) {
+        const std::uint32_t a = crc ^ (p[0] | p[1] << 8 | p[2] << 16 | std::uint32_t(p[3]) << 24);
+        const std::uint32_t b = p[4] | p[5] << 8 | p[6] << 16 | std::uint32_t(p[7]) << 24;
+        crc = t[7][a & 0xff] ^ t[6][(a >> 8) & 0xff] ^ t[5][(a >> 16) & 0xff] ^ t[4][a >> 24]
+            ^ t[3][b & 0xff] ^ t[2][(b >> 8) & 0xff] ^ t[1][(b >> 16) & 0xff] ^ t[0][b >> 24];
+    }
+    for (; n > 0; --n) crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+inline std::uint32_t reverseBits(std::uint32_t code, int len) {
+    std::uint32_t r = 0;
+    for (int k = 0; k < len; ++k, code >>= 1) r = r << 1 | (code & 1);
+    return r;
+}
+
+/**
+ * @brief Canonical codes of the given lengths, bit reversed as deflate
+ *        sends them least significant bit first.
+ */
+void canonicalCodes(const std::uint8_t* lengths, int n, std::uint16_t* codes) {
+    std::uint16_t count[16] = {}, next[16] = {};
+    for (int s = 0; s < n; ++s) ++count[lengths[s]];
+    count[0] = 0;
+    std::uint32_t code = 0;
+    for (int len = 1; len < 16; ++len) {
+        code = (code + count[len - 1]) << 1;
+        next[len] = std::uint16_t(code);
+    }
+    for (int s = 0; s < n; ++s)
+        if (lengths[s]) codes[s] = std::uint16_t(reverseBits(next[lengths[s]]++, lengths[s]));
+}
+
+/**
+ * @brief Huffman code lengths of at most limit bits for the frequencies.
+ *        At least two symbols get a code so the code is complete; too deep
+ *        trees are rebuilt from halved frequencies until they fit.
+ */
+void buildLengths(const std::uint32_t* frequencies, int n, int limit, std::uint8_t* lengths) {
+    std::vector<std::uint32_t> freq(frequencies, frequencies + n);
+    int used = int(std::count_if(freq.begin(), freq.end(), [](std::uint32_t f) { return f > 0; }));
+    for (int s = 0; used < 2 && s < n; ++s)
+        if (!freq[s]) { freq[s] = 1; ++used; }
+    std::vector<std::pair<std::uint32_t, int>> leaves;
+    std::vector<std::uint64_t> weight;
+    std::vector<int> parent, depth;
+    for (;;) {
+        leaves.clear();
+        for (int s = 0; s < n; ++s)
+            if (freq[s]) leaves.push_back({ freq[s], s });
+        std::sort(leaves.begin(), leaves.end());
+        // two-queue Huffman: sorted leaves, internal nodes in creation order
+        const int m = int(leaves.size()), nodes = 2 * m - 1;
+        weight.assign(nodes, 0);
+        parent.assign(nodes, 0);
+        depth.assign(nodes, 0);
+        for (int k = 0; k < m; ++k) weight[k] = leaves[k].first;
+        int li = 0, ii = m;
+        for (int k = m; k < nodes; ++k) {
+            auto pick = [&]() { return li < m && (ii >= k || weight[li] <= weight[ii]) ? li++ : ii++; };
+            const int a = pick(), b = pick();
+            weight[k] = weight[a] + weight[b];
+            parent[a] = parent[b] = k;
+        }
+        int deepest = 0;
+        for (int k = nodes - 2; k >= 0; --k) {
+            depth[k] = depth[parent[k]] + 1;
+            deepest = std::max(deepest, depth[k]);
+        }
+        if (deepest <= limit) {
+            std::fill(lengths, lengths + n, 0);
+            for (int k = 0; k < m; ++k) lengths[leaves[k].second] = std::uint8_t(depth[k]);
+            return;
+        }
+        for (auto& f : freq)
+            if (f) f = (f + 1) / 2;
+    }
+}
+
+int lengthCode(int len) {
+    int c = 0;
+    while (c < 28 && kLenBase[c + 1] <= len) ++c;
+    return c;
+}
+
+int distanceCode(std::uint32_t dist) {
+    if (dist <= 4) return int(dist) - 1;
+    const std::uint32_t x = dist - 1;
+    int log = 0;
+    while (x >> (log + 1)) ++log;
+    return 2 * log + int((x >> (log - 1)) & 1);
+}
+
+/**
+ * @brief Length code per match length, built once.
+ */
+struct LengthCodes {
+    std::uint8_t code[kMaxMatch + 1];
+    LengthCodes() {
+        for (int len = 3; len <= int(kMaxMatch); ++len) code[len] = std::uint8_t(lengthCode(len));
+    }
+};
+
+inline std::uint32_t hash3(const unsigned char* p) {
+    const std::uint32_t v = std::uint32_t(p[0]) << 16 | std::uint32_t(p[1]) << 8 | p[2];
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+} // namespace
+
+bool isGzipName(const std::string& filename) {
+    return filename.size() > 3 && filename.compare(filename.size() - 3, 3, ".gz") == 0;
+}
+
+// ---------------------------------------------------------------- inflate
+
+InflateBuf::InflateBuf(std::istream& src)
+    : src_(src), in_(kInputBlock), out_(kWindow + kStep + kMaxMatch) {}
+
+bool InflateBuf::detect(std::istream& in) { return in.peek() == 0x1f; }
+
+/**
+ * @brief Build the decoding tables of a canonical code.
+ * @throws runtime_error on an over-subscribed code.
+ */
+void InflateBuf::Huffman::build(const std::uint8_t* lengths, int n) {
+    std::fill(count, count + 16, 0);
+    for (int s = 0; s < n; ++s) ++count[lengths[s]];
+    count[0] = 0;
+    int left = 1;
+    for (int len = 1; len < 16; ++len) {
+        left = (left << 1) - count[len];
+        if (left < 0) throw std::runtime_error("Invalid Huffman code in gzip data");
+    }
+    std::uint16_t offset[16] = {};
+    for (int len = 1; len < 15; ++len) offset[len + 1] = std::uint16_t(offset[len] + count[len]);
+    symbols.assign(n, 0);
+    for (int s = 0; s < n; ++s)
+        if (lengths[s]) symbols[offset[lengths[s]]++] = std::uint16_t(s);
+    std::vector<std::uint16_t> codes(n);
+    canonicalCodes(lengths, n, codes.data());
+    fast.assign(std::size_t(1) << kFastBits, 0);
+    for (int s = 0; s < n; ++s) {
+        const int len = lengths[s];
+        if (!len || len > kFastBits) continue;
+        for (std::size_t k = codes[s]; k < fast.size(); k += std::size_t(1) << len)
+            fast[k] = std::uint16_t(s | len << 9);
+    }
+}
+
+bool InflateBuf::fillInput() {
+    if (!src_) return false;
+    src_.read(reinterpret_cast<char*>(in_.data()), in_.size());
+    inPos_ = 0;
+    inEnd_ = std::size_t(src_.gcount());
+    return inEnd_ > 0;
+}
+
+/**
+ * @brief Top the bit buffer up to at least 57 bits, or to the end of input.
+ */
+void InflateBuf::refill() {
+    while (bitCount_ <= 56) {
+        if (inPos_ == inEnd_ && !fillInput()) return;
+        bits_ |= std::uint64_t(in_[inPos_++]) << bitCount_;
+        bitCount_ += 8;
+    }
+}
+
+std::uint32_t InflateBuf::getBits(int n) {
+    if (bitCount_ < n) refill();
+    if (bitCount_ < n) throw std::runtime_error("Truncated gzip data");
+    const std::uint32_t v = std::uint32_t(bits_ & ((std::uint64_t(1) << n) - 1));
+    bits_ >>= n;
+    bitCount_ -= n;
+    return v;
+}
+
+/**
+ * @brief Next symbol of code h.
+ * @throws runtime_error on an invalid code or the end of input.
+ */
+int InflateBuf::decode(const Huffman& h) {
+    if (bitCount_ < 15) refill();
+    const std::uint16_t entry = h.fast[bits_ & ((1u << Huffman::kFastBits) - 1)];
+    if (entry) {
+        const int len = entry >> 9;
+        if (len > bitCount_) throw std::runtime_error("Truncated gzip data");
+        bits_ >>= len;
+        bitCount_ -= len;
+        return entry & 511;
+    }
+    // codes are sent most significant bit first
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len < 16; ++len) {
+        if (len > bitCount_) throw std::runtime_error("Truncated gzip data");
+        code |= int((bits_ >> (len - 1)) & 1);
+        const int count = h.count[len];
+        if (code - first < count) {
+            bits_ >>= len;
+            bitCount_ -= len;
+            return h.symbols[index + code - first];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    throw std::runtime_error("Invalid Huffman code in gzip data");
+}
+
+/**
+ * @brief Skip a member header: magic, method, flags and the optional fields.
+ */
+void InflateBuf::readMemberHeader() {
+    if (getBits(8) != 0x1f || getBits(8) != 0x8b) throw std::runtime_error("Invalid gzip header");
+    if (getBits(8) != 8) throw std::runtime_error("Unsupported gzip compression method");
+    const std::uint32_t flags = getBits(8);
+    getBits(32);   // modification time
+    getBits(16);   // extra flags, operating system
+    if (flags & 4) {
+        const std::uint32_t length = getBits(16);
+        for (std::uint32_t k = 0; k < length; ++k) getBits(8);
+    }
+    if (flags & 8)  while (getBits(8) != 0) {}    // file name
+    if (flags & 16) while (getBits(8) != 0) {}    // comment
+    if (flags & 2)  getBits(16);                  // header CRC
+    crc_ = 0;
+    size_ = 0;
+    state_ = BlockStart;
+}
+
+/**
+ * @brief Check CRC and size of the member just inflated, then look for
+ *        another member. Anything else after it is ignored, as gzip does.
+ */
+void InflateBuf::readMemberTrailer() {
+    updateCrc();
+    getBits(bitCount_ % 8);
+    const std::uint32_t crc = getBits(32), size = getBits(32);
+    if (crc != crc_ || size != size_) throw std::runtime_error("Corrupt gzip data (CRC or size mismatch)");
+    refill();
+    state_ = bitCount_ >= 16 && (bits_ & 0xffff) == 0x8b1f ? MemberStart : Done;
+}
+
+void InflateBuf::readBlockHeader() {
+    last_ = getBits(1) != 0;
+    const std::uint32_t type = getBits(2);
+    if (type == 0) {
+        getBits(bitCount_ % 8);
+        const std::uint32_t len = getBits(16), nlen = getBits(16);
+        if (len != (~nlen & 0xffff)) throw std::runtime_error("Corrupt stored block in gzip data");
+        storedLeft_ = len;
+        state_ = Stored;
+    } else if (type == 1) {
+        std::uint8_t lengths[288 + 32];
+        std::fill(lengths, lengths + 144, 8);
+        std::fill(lengths + 144, lengths + 256, 9);
+        std::fill(lengths + 256, lengths + 280, 7);
+        std::fill(lengths + 280, lengths + 288, 8);
+        std::fill(lengths + 288, lengths + 320, 5);
+        lit_.build(lengths, 288);
+        dist_.build(lengths + 288, 32);
+        state_ = Coded;
+    } else if (type == 2) {
+        readDynamicTrees();
+        state_ = Coded;
+    } else {
+        throw std::runtime_error("Invalid block type in gzip data");
+    }
+}
+
+void InflateBuf::readDynamicTrees() {
+    const int hlit = int(getBits(5)) + 257, hdist = int(getBits(5)) + 1, hclen = int(getBits(4)) + 4;
+    if (hlit > 286 || hdist > 30) throw std::runtime_error("Invalid code counts in gzip data");
+    std::uint8_t codeLengths[19] = {};
+    for (int k = 0; k < hclen; ++k) codeLengths[kCodeLengthOrder[k]] = std::uint8_t(getBits(3));
+    Huffman codes;
+    codes.build(codeLengths, 19);
+    std::uint8_t lengths[286 + 30] = {};
+    for (int i = 0; i < hlit + hdist;) {
+        const int sym = decode(codes);
+        if (sym < 16) {
+            lengths[i++] = std::uint8_t(sym);
+            continue;
+        }
+        std::uint8_t value = 0;
+        int repeat;
+        if (sym == 16) {
+            if (i == 0) throw std::runtime_error("Invalid code lengths in gzip data");
+            value = lengths[i - 1];
+            repeat = 3 + int(getBits(2));
+        } else if (sym == 17) {
+            repeat = 3 + int(getBits(3));
+        } else {
+            repeat = 11 + int(getBits(7));
+        }
+        if (i + repeat > hlit + hdist) throw std::runtime_error("Invalid code lengths in gzip data");
+        std::fill(lengths + i, lengths + i + repeat, value);
+        i += repeat;
+    }
+    if (!lengths[256]) throw std::runtime_error("Missing end-of-block code in gzip data");
+    lit_.build(lengths, hlit);
+    dist_.build(lengths + hlit, hdist);
+}
+
+void InflateBuf::updateCrc() {
+    crc_ = crc32(crc_, out_.data() + crcPos_, outEnd_ - crcPos_);
+    size_ += std::uint32_t(outEnd_ - crcPos_);
+    crcPos_ = outEnd_;
+}
+
+/**
+ * @brief Inflate until a step of output is ready or the stream ends. Stops
+ *        only between symbols, so a match never has to be resumed.
+ */
+void InflateBuf::inflateStep() {
+    const std::size_t limit = kWindow + kStep;
+    unsigned char* out = out_.data();
+    while (outEnd_ < limit && state_ != Done) {
+        switch (state_) {
+        case MemberStart:
+            readMemberHeader();
+            break;
+        case BlockStart:
+            readBlockHeader();
+            break;
+        case Stored: {
+            std::size_t n = std::min(storedLeft_, limit - outEnd_);
+            storedLeft_ -= n;
+            // the header left the bit buffer byte aligned
+            for (; n > 0 && bitCount_ >= 8; --n) {
+                out[outEnd_++] = (unsigned char)bits_;
+                bits_ >>= 8;
+                bitCount_ -= 8;
+            }
+            while (n > 0) {
+                if (inPos_ == inEnd_ && !fillInput()) throw std::runtime_error("Truncated gzip data");
+                const std::size_t k = std::min(n, inEnd_ - inPos_);
+                std::memcpy(out + outEnd_, in_.data() + inPos_, k);
+                inPos_ += k;
+                outEnd_ += k;
+                n -= k;
+            }
+            if (storedLeft_ == 0) {
+                if (last_) readMemberTrailer();
+                else       state_ = BlockStart;
+            }
+            break;
+        }
+        case Coded:
+            while (outEnd_ < limit) {
+                // one refill covers a length, a distance and their extra bits
+                if (bitCount_ < 48) refill();
+                int sym = decode(lit_);
+                if (sym < 256) {
+                    out[outEnd_++] = (unsigned char)sym;
+                    continue;
+                }
+                if (sym == 256) {
+                    if (last_) readMemberTrailer();
+                    else       state_ = BlockStart;
+                    break;
+                }
+                sym -= 257;
+                if (sym >= 29) throw std::runtime_error("Invalid length code in gzip data");
+                const std::size_t len = kLenBase[sym] + getBits(kLenExtra[sym]);
+                const int d = decode(dist_);
+                if (d >= 30) throw std::runtime_error("Invalid distance code in gzip data");
+                const std::size_t dist = kDistBase[d] + getBits(kDistExtra[d]);
+                if (dist > outEnd_) throw std::runtime_error("Invalid distance in gzip data");
+                unsigned char* dst = out + outEnd_;
+                const unsigned char* src = dst - dist;
+                if (dist >= len) {
+                    std::memcpy(dst, src, len);
+                } else {
+                    // overlapping copy repeats the last dist bytes
+                    for (std::size_t k = 0; k < len; ++k) dst[k] = src[k];
+                }
+                outEnd_ += len;
+            }
+            break;
+        case Done:
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Keep the last 32 KiB as history and inflate the next step after it.
+ * @throws runtime_error on truncated or corrupt data.
+ */
+InflateBuf::int_type InflateBuf::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    if (outEnd_ > kWindow) {
+        std::memmove(out_.data(), out_.data() + outEnd_ - kWindow, kWindow);
+        outEnd_ = crcPos_ = kWindow;
+    }
+    const std::size_t start = outEnd_;
+    inflateStep();
+    updateCrc();
+    char* base = reinterpret_cast<char*>(out_.data());
+    setg(base + start, base + start, base + outEnd_);
+    if (start == outEnd_) return traits_type::eof();
+    return traits_type::to_int_type(*gptr());
+}
+
+// ---------------------------------------------------------------- deflate
+
+/**
+ * @brief Write the gzip header: no name or time, "fastest" extra flag.
+ */
+DeflateBuf::DeflateBuf(std::ostream& dst)
+    : dst_(dst), data_(kWindow + kStep), head_(std::size_t(1) << kHashBits, -1) {
+    static const unsigned char header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 4, 255 };
+    dst_.write(reinterpret_cast<const char*>(header), sizeof header);
+    char* base = reinterpret_cast<char*>(data_.data());
+    setp(base, base + kStep);
+}
+
+DeflateBuf::~DeflateBuf() {
+    try {
+        finish();
+    } catch (...) {
+    }
+}
+
+DeflateBuf::int_type DeflateBuf::overflow(int_type ch) {
+    compressBlock(false);
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+void DeflateBuf::putBits(std::uint32_t value, int n) {
+    bits_ |= std::uint64_t(value) << bitCount_;
+    bitCount_ += n;
+    if (bitCount_ >= 32) {
+        for (int k = 0; k < 4; ++k) bytes_.push_back((unsigned char)(bits_ >> 8 * k));
+        bits_ >>= 32;
+        bitCount_ -= 32;
+    }
+}
+
+/**
+ * @brief Move complete bytes to the destination; with all, pad the last
+ *        partial byte with zero bits first.
+ */
+void DeflateBuf::flushBytes(bool all) {
+    for (; bitCount_ >= 8; bitCount_ -= 8, bits_ >>= 8) bytes_.push_back((unsigned char)bits_);
+    if (all && bitCount_ > 0) {
+        bytes_.push_back((unsigned char)bits_);
+        bits_ = 0;
+        bitCount_ = 0;
+    }
+    dst_.write(reinterpret_cast<const char*>(bytes_.data()), bytes_.size());
+    bytes_.clear();
+}
+
+void DeflateBuf::writeStored(const unsigned char* data, std::size_t n, bool last) {
+    do {
+        const std::size_t k = std::min(n, kMaxStored);
+        putBits(last && k == n ? 1 : 0, 1);
+        putBits(0, 2);
+        flushBytes(true);
+        const unsigned char len[4] = { (unsigned char)k, (unsigned char)(k >> 8),
+                                       (unsigned char)~k, (unsigned char)(~k >> 8) };
+        dst_.write(reinterpret_cast<const char*>(len), sizeof len);
+        dst_.write(reinterpret_cast<const char*>(data), k);
+        data += k;
+        n -= k;
+    } while (n > 0);
+}
+
+/**
+ * @brief Compress the pending input into one block: greedy matches against
+ *        the most recent string with the same 3-byte hash, then a dynamic
+ *        Huffman block, or stored blocks when that is smaller. Keeps the last
+ *        32 KiB as history for the next block.
+ */
+void DeflateBuf::compressBlock(bool last) {
+    static const LengthCodes lengthCodes;
+    unsigned char* data = data_.data();
+    const std::size_t end = std::size_t(pptr() - reinterpret_cast<char*>(data));
+    const std::size_t n = end - history_;
+    crc_ = crc32(crc_, data + history_, n);
+    size_ += std::uint32_t(n);
+
+    tokens_.clear();
+    std::uint32_t litFreq[286] = {}, distFreq[30] = {};
+    for (std::size_t i = history_; i < end;) {
+        std::size_t best = 0, bestDist = 0;
+        if (i + 3 <= end) {
+            const std::uint32_t h = hash3(data + i);
+            const long long pos = consumed_ + (long long)i, candidate = head_[h];
+            head_[h] = pos;
+            if (candidate >= consumed_ && pos - candidate <= (long long)kWindow) {
+                const unsigned char* a = data + (candidate - consumed_);
+                const unsigned char* b = data + i;
+                const std::size_t maxLen = std::min(kMaxMatch, end - i);
+                std::size_t len = 0;
+                while (len < maxLen && a[len] == b[len]) ++len;
+                if (len >= 3) {
+                    best = len;
+                    bestDist = std::size_t(pos - candidate);
+                }
+            }
+        }
+        if (!best) {
+            tokens_.push_back(data[i]);
+            ++litFreq[data[i]];
+            ++i;
+            continue;
+        }
+        tokens_.push_back(std::uint32_t(best) << 16 | std::uint32_t(bestDist));
+        ++litFreq[257 + lengthCodes.code[best]];
+        ++distFreq[distanceCode(std::uint32_t(bestDist))];
+        for (std::size_t k = i + 1; k < i + best && k + 3 <= end; ++k)
+            head_[hash3(data + k)] = consumed_ + (long long)k;
+        i += best;
+    }
+    litFreq[256] = 1;
+
+    std::uint8_t litLen[286], distLen[30], clLen[19];
+    buildLengths(litFreq, 286, 15, litLen);
+    buildLengths(distFreq, 30, 15, distLen);
+    int hlit = 286, hdist = 30;
+    while (hlit > 257 && !litLen[hlit - 1]) --hlit;
+    while (hdist > 1 && !distLen[hdist - 1]) --hdist;
+
+    // run-length coded code lengths: symbol | repeat count << 5
+    std::uint8_t all[286 + 30];
+    std::copy(litLen, litLen + hlit, all);
+    std::copy(distLen, distLen + hdist, all + hlit);
+    std::vector<std::uint16_t> rle;
+    std::uint32_t clFreq[19] = {};
+    const int total = hlit + hdist;
+    for (int i = 0; i < total;) {
+        const int v = all[i];
+        int run = 1;
+        while (i + run < total && all[i + run] == v) ++run;
+        i += run;
+        if (v == 0) {
+            for (; run >= 11; ) {
+                const int r = std::min(run, 138);
+                rle.push_back(std::uint16_t(18 | (r - 11) << 5));
+                ++clFreq[18];
+                run -= r;
+            }
+            if (run >= 3) {
+                rle.push_back(std::uint16_t(17 | (run - 3) << 5));
+                ++clFreq[17];
+                run = 0;
+            }
+        } else {
+            rle.push_back(std::uint16_t(v));
+            ++clFreq[v];
+            --run;
+            for (; run >= 3; ) {
+                const int r = std::min(run, 6);
+                rle.push_back(std::uint16_t(16 | (r - 3) << 5));
+                ++clFreq[16];
+                run -= r;
+            }
+        }
+        for (; run > 0; --run) {
+            rle.push_back(std::uint16_t(v));
+            ++clFreq[v];
+        }
+    }
+    buildLengths(clFreq, 19, 7, clLen);
+    int hclen = 19;
+    while (hclen > 4 && !clLen[kCodeLengthOrder[hclen - 1]]) --hclen;
+
+    static const int kRepeatBits[19] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 7 };
+    std::uint64_t dynamicBits = 3 + 14 + 3 * hclen;
+    for (std::uint16_t r : rle) dynamicBits += clLen[r & 31] + kRepeatBits[r & 31];
+    for (int s = 0; s < 286; ++s) dynamicBits += std::uint64_t(litFreq[s]) * litLen[s];
+    for (int c = 0; c < 29; ++c) dynamicBits += std::uint64_t(litFreq[257 + c]) * kLenExtra[c];
+    for (int c = 0; c < 30; ++c) dynamicBits += std::uint64_t(distFreq[c]) * (distLen[c] + kDistExtra[c]);
+    const std::uint64_t storedBits = 8 * (n + 5 * (n / kMaxStored + 1)) + 7;
+
+    if (storedBits < dynamicBits) {
+        writeStored(data + history_, n, last);
+    } else {
+        std::uint16_t litCode[286] = {}, distCode[30] = {}, clCode[19] = {};
+        canonicalCodes(litLen, 286, litCode);
+        canonicalCodes(distLen, 30, distCode);
+        canonicalCodes(clLen, 19, clCode);
+        putBits(last ? 1 : 0, 1);
+        putBits(2, 2);
+        putBits(std::uint32_t(hlit - 257), 5);
+        putBits(std::uint32_t(hdist - 1), 5);
+        putBits(std::uint32_t(hclen - 4), 4);
+        for (int k = 0; k < hclen; ++k) putBits(clLen[kCodeLengthOrder[k]], 3);
+        for (std::uint16_t r : rle) {
+            const int sym = r & 31;
+            putBits(clCode[sym], clLen[sym]);
+            if (kRepeatBits[sym]) putBits(r >> 5, kRepeatBits[sym]);
+        }
+        for (std::uint32_t t : tokens_) {
+            if (t < 256) {
+                putBits(litCode[t], litLen[t]);
+                continue;
+            }
+            const int len = int(t >> 16), c = lengthCodes.code[len];
+            const std::uint32_t dist = t & 0xffff;
+            putBits(litCode[257 + c], litLen[257 + c]);
+            putBits(std::uint32_t(len - kLenBase[c]), kLenExtra[c]);
+            const int d = distanceCode(dist);
+            putBits(distCode[d], distLen[d]);
+            putBits(dist - kDistBase[d], kDistExtra[d]);
+        }
+        putBits(litCode[256], litLen[256]);
+        flushBytes(false);
+    }
+
+    const std::size_t keep = std::min(end, kWindow);
+    std::memmove(data, data + end - keep, keep);
+    consumed_ += (long long)(end - keep);
+    history_ = keep;
+    char* base = reinterpret_cast<char*>(data);
+    setp(base + keep, base + keep + kStep);
+}
+
+/**
+ * @brief Final block, padding and the CRC/size trailer.
+ * @throws runtime_error if the destination fails.
+ */
+void DeflateBuf::finish() {
+    if (finished_) return;
+    finished_ = true;
+    compressBlock(true);
+    flushBytes(true);
+    unsigned char trailer[8];
+    for (int k = 0; k < 4; ++k) {
+        trailer[k] = (unsigned char)(crc_ >> 8 * k);
+        trailer[4 + k] = (unsigned char)(size_ >> 8 * k);
+    }
+    dst_.write(reinterpret_cast<const char*>(trailer), sizeof trailer);
+    dst_.flush();
+    if (!dst_) throw std::runtime_error("Cannot write output file");
+}
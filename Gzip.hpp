@@ -0,0 +1,132 @@
+#include <vector>
+#include <string>
+#include <streambuf>
+#include <iosfwd>
+#include <cstdint>
+
+#ifndef GZIP_HPP
+#define GZIP_HPP
+
+/**
+ * @brief True if filename ends in ".gz".
+ */
+bool isGzipName(const std::string& filename);
+
+/**
+ * @class InflateBuf
+ * @brief Stream buffer that decompresses gzip data (RFC 1952 members of
+ *        RFC 1951 deflate blocks) from a source stream as it is read, so a
+ *        parser on top of it never sees the compressed bytes and no
+ *        temporary file is needed. Concatenated members read as one stream;
+ *        every member's CRC and size are checked. Output is produced in 64 KiB
+ *        steps on top of the 32 KiB history deflate refers back into.
+ */
+class InflateBuf : public std::streambuf {
+public:
+    /**
+     * @brief Read compressed data from src, which must stay open. Not owned.
+     */
+    explicit InflateBuf(std::istream& src);
+
+    /** @brief Whether in starts with the gzip magic; consumes nothing. */
+    static bool detect(std::istream& in);
+
+protected:
+    /**
+     * @brief Decompress the next step of output.
+     * @throws runtime_error on truncated or corrupt data.
+     */
+    int_type underflow() override;
+
+private:
+    /**
+     * @struct Huffman
+     * @brief Canonical Huffman decoder: a table indexed by the next kFastBits
+     *        input bits resolves short codes at once, longer ones are walked
+     *        bit by bit through the per-length counts.
+     */
+    struct Huffman {
+        static const int kFastBits = 10;
+        std::vector<std::uint16_t> fast;   // symbol | length << 9; 0 for longer codes
+        std::uint16_t count[16] = {};
+        std::vector<std::uint16_t> symbols; // ordered by code
+
+        /** @throws runtime_error on an over-subscribed code. */
+        void build(const std::uint8_t* lengths, int n);
+    };
+
+    enum State { MemberStart, BlockStart, Stored, Coded, Done };
+
+    std::istream& src_;
+    std::vector<unsigned char> in_;
+    std::size_t inPos_ = 0, inEnd_ = 0;
+    std::uint64_t bits_ = 0;
+    int bitCount_ = 0;
+
+    std::vector<unsigned char> out_;   // history, then the bytes being handed out
+    std::size_t outEnd_ = 0, crcPos_ = 0;
+
+    State state_ = MemberStart;
+    bool last_ = false;
+    std::size_t storedLeft_ = 0;
+    Huffman lit_, dist_;
+    std::uint32_t crc_ = 0, size_ = 0;
+
+    bool fillInput();
+    void refill();
+    std::uint32_t getBits(int n);
+    int decode(const Huffman& h);
+    void readMemberHeader();
+    void readMemberTrailer();
+    void readBlockHeader();
+    void readDynamicTrees();
+    void updateCrc();
+    void inflateStep();
+};
+
+/**
+ * @class DeflateBuf
+ * @brief Stream buffer that gzip-compresses everything written to it into a
+ *        destination stream. Tuned for speed like gzip -1: a greedy match
+ *        search with one candidate per hash, then a dynamic Huffman block per
+ *        64 KiB of input (or a stored block if that is smaller).
+ */
+class DeflateBuf : public std::streambuf {
+public:
+    /**
+     * @brief Write the gzip header to dst, which must stay open. Not owned.
+     */
+    explicit DeflateBuf(std::ostream& dst);
+
+    /** @brief Finishes the stream if finish() was not called; errors are lost. */
+    ~DeflateBuf() override;
+
+    /**
+     * @brief Compress the rest, write the final block and the trailer.
+     * @throws runtime_error if the destination fails.
+     */
+    void finish();
+
+protected:
+    int_type overflow(int_type ch) override;
+
+private:
+    std::ostream& dst_;
+    std::vector<unsigned char> data_;   // history, then input not yet compressed
+    std::size_t history_ = 0;           // bytes of history at the start of data_
+    long long consumed_ = 0;            // stream offset of data_[0]
+    std::vector<long long> head_;       // stream offset of the last 3-byte string per hash
+    std::vector<std::uint32_t> tokens_; // literal, or length << 16 | distance
+    std::vector<unsigned char> bytes_;
+    std::uint64_t bits_ = 0;
+    int bitCount_ = 0;
+    std::uint32_t crc_ = 0, size_ = 0;
+    bool finished_ = false;
+
+    void putBits(std::uint32_t value, int n);
+    void flushBytes(bool all);
+    void compressBlock(bool last);
+    void writeStored(const unsigned char* data, std::size_t n, bool last);
+};
+
+#endif // !GZIP_HPP
@@ -5,130 +5,312 @@
 #include <iostream>
 #include <stdexcept>
 #include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <utility>
 #include "Image.hpp"
+#include "Pnm.hpp"
+#include "Qoi.hpp"
+#include "Gzip.hpp"
+#include "Kernels.hpp"
 
 /**
- * @brief Load P2 or P3 image, capturing comment lines.
+ * @brief Load a netpbm or QOI image, capturing comment lines; gzip
+ *        compressed files are inflated while they are parsed.
  * @param filename Path to input file.
  * @throws runtime_error on I/O or format error.
  */
 Image::Image(const std::string& filename) {
-    std::ifstream in(filename);
+    std::ifstream in(filename, std::ios::binary);
     if (!in) throw std::runtime_error("Cannot open input file");
+    if (InflateBuf::detect(in)) {
+        InflateBuf inflate(in);
+        std::istream gz(&inflate);
+        gz.exceptions(std::ios::badbit);   // corrupt data reports its own error
+        *this = Image(gz);
+        return;
+    }
+    *this = Image(in);
+}
+
+/**
+ * @brief Parse a netpbm image from a stream.
+ * @param in Input stream positioned at the magic number.
+ * @throws runtime_error on format error.
+ */
+Image::Image(std::istream& in) {
+    if (in.peek() == 'q') {
+        const QoiHeader header = QoiHeader::read(in);
+        channels_ = header.channels;
+        magic_ = "qoif";
+        colorspace_ = header.colorspace;
+        width_ = header.width;
+        height_ = header.height;
+        maxValue_ = 255;
+        pixels_.resize(std::size_t(width_) * height_ * channels_);
+        QoiCodec::decode(in, header, pixels_.data());
+        return;
+    }
+    PnmHeader header = PnmHeader::read(in);
+    channels_ = header.channels();
+    magic_ = header.magic;
+    tupleType_ = header.tupleType;
+    comments_ = std::move(header.comments);
+    width_ = header.width;
+    height_ = header.height;
+    maxValue_ = header.maxValue;
+    scale_ = header.scale;
 
-    std::string magic;
-    in >> magic;
-    if      (magic == "P2") isColor_ = false;
-    else if (magic == "P3") isColor_ = true;
-    else throw std::runtime_error("Invalid magic (expected P2 or P3)");
-
-    std::string line;
-    std::getline(in, line);  // finish magic line
-    // capture comments
-    while (in.peek() == '#') {
-        std::getline(in, line);
-        comments_.push_back(line);
+    pixels_.resize(std::size_t(width_) * height_ * channels_);
+    if (header.isFloat()) {
+        // rows are stored bottom to top, in the byte order the scale's sign gives
+        const bool little = scale_ < 0;
+        const std::size_t rowLen = std::size_t(width_) * channels_;
+        std::vector<unsigned char> buffer(rowLen * 4);
+        for (int i = height_ - 1; i >= 0; --i) {
+            if (!in.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+                throw std::runtime_error("Insufficient pixel data");
+            int* row = rowData(i);
+            for (std::size_t k = 0; k < rowLen; ++k) {
+                const unsigned char* b = &buffer[4 * k];
+                const std::uint32_t bits = little
+                    ? std::uint32_t(b[0]) | std::uint32_t(b[1]) << 8 | std::uint32_t(b[2]) << 16 | std::uint32_t(b[3]) << 24
+                    : std::uint32_t(b[3]) | std::uint32_t(b[2]) << 8 | std::uint32_t(b[1]) << 16 | std::uint32_t(b[0]) << 24;
+                row[k] = int(bits);
+            }
+        }
+        return;
+    }
+    if (header.binary()) {
+        const int bytes = header.sampleBytes();
+        const std::size_t rowLen = std::size_t(width_) * channels_;
+        std::vector<unsigned char> buffer(rowLen * bytes);
+        for (int i = 0; i < height_; ++i) {
+            if (!in.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+                throw std::runtime_error("Insufficient pixel data");
+            int* row = rowData(i);
+            if (bytes == 1) {
+                for (std::size_t k = 0; k < rowLen; ++k) row[k] = buffer[k];
+            } else {
+                for (std::size_t k = 0; k < rowLen; ++k) row[k] = buffer[2 * k] << 8 | buffer[2 * k + 1];
+            }
+            for (std::size_t k = 0; k < rowLen; ++k)
+                if (row[k] > maxValue_) throw std::runtime_error("Sample above max value");
+        }
+        return;
     }
-    in >> width_ >> height_ >> maxValue_;
-    if (width_<=0 || height_<=0 || maxValue_<=0)
-        throw std::runtime_error("Invalid dimensions or max value");
-
-    if (!isColor_) {
-        gray_.assign(height_, std::vector<int>(width_));
-        for (int i = 0; i < height_; ++i)
-            for (int j = 0; j < width_; ++j)
-                if (!(in >> gray_[i][j]))
-                    throw std::runtime_error("Insufficient gray pixel data");
-    } else {
-        color_.assign(height_, std::vector<std::array<int,3>>(width_));
-        for (int i = 0; i < height_; ++i)
-            for (int j = 0; j < width_; ++j)
-                for (int c = 0; c < 3; ++c)
-                    if (!(in >> color_[i][j][c]))
-                        throw std::runtime_error("Insufficient color pixel data");
+    for (auto& v : pixels_) {
+        if (!(in >> v))
+            throw std::runtime_error(channels_ == 1 ? "Insufficient gray pixel data"
+                                                    : "Insufficient color pixel data");
+        // the energy and seam cost bounds rely on it
+        if (v < 0 || v > maxValue_) throw std::runtime_error("Sample above max value");
     }
 }
 
 /**
- * @brief Write image in same format (P2 or P3), re-emitting comments.
+ * @brief Create a zero-filled image.
+ * @throws runtime_error on invalid dimensions.
+ */
+Image::Image(int width, int height, int channels, int maxValue)
+    : width_(width), height_(height), maxValue_(maxValue), channels_(channels) {
+    if (width_<=0 || height_<=0 || maxValue_<=0 || channels_<=0)
+        throw std::runtime_error("Invalid dimensions, channels or max value");
+    const PnmHeader header = PnmHeader::forChannels(channels_, false);
+    magic_ = header.magic;
+    tupleType_ = header.tupleType;
+    pixels_.resize(std::size_t(width_) * height_ * channels_);
+}
+
+/**
+ * @brief Write image in its input format, re-emitting comments; gzip
+ *        compressed if filename ends in ".gz".
  * @param filename Path to output file.
  * @throws runtime_error on I/O error.
  */
 void Image::write(const std::string& filename) const {
-    std::ofstream out(filename);
+    std::ofstream out(filename, std::ios::binary);
     if (!out) throw std::runtime_error("Cannot open output file");
+    if (isGzipName(filename)) {
+        DeflateBuf deflate(out);
+        std::ostream gz(&deflate);
+        gz.exceptions(std::ios::badbit);
+        write(gz);
+        deflate.finish();
+        return;
+    }
+    write(out);
+}
 
-    // magic
-    out << (isColor_ ? "P3" : "P2") << '\n';
-    // comments
-    for (const auto& c : comments_) out << c << '\n';
-    // dimensions and max
-    out << width_ << ' ' << height_ << '\n'
-        << maxValue_ << '\n';
+/**
+ * @brief Write image in its input format to a stream.
+ * @param out Output stream.
+ */
+void Image::write(std::ostream& out) const {
+    if (magic_ == "qoif") {
+        QoiHeader header;
+        header.width = width_;
+        header.height = height_;
+        header.channels = channels_ % 2 == 0 ? 4 : 3;
+        header.colorspace = colorspace_;
+        QoiCodec::encode(out, header, pixels_.data(), channels_);
+        return;
+    }
+    PnmHeader header;
+    header.magic = magic_;
+    header.tupleType = tupleType_;
+    header.depth = channels_;
+    header.comments = comments_;
+    header.width = width_;
+    header.height = height_;
+    header.maxValue = maxValue_;
+    header.scale = scale_;
+    header.write(out);
 
-    // pixel data
-    if (!isColor_) {
-        for (int i = 0; i < height_; ++i) {
-            for (int j = 0; j < width_; ++j) {
-                out << gray_[i][j] << ' ';
+    if (header.isFloat()) {
+        const bool little = scale_ < 0;
+        const std::size_t rowLen = std::size_t(width_) * channels_;
+        std::vector<unsigned char> buffer(rowLen * 4);
+        for (int i = height_ - 1; i >= 0; --i) {
+            const int* row = rowData(i);
+            for (std::size_t k = 0; k < rowLen; ++k) {
+                const std::uint32_t bits = std::uint32_t(row[k]);
+                unsigned char* b = &buffer[4 * k];
+                for (int byte = 0; byte < 4; ++byte)
+                    b[little ? byte : 3 - byte] = (unsigned char)(bits >> 8 * byte);
             }
-            out << '\n';
+            out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
         }
-    } else {
+        return;
+    }
+    if (header.binary()) {
+        const int bytes = header.sampleBytes();
+        const std::size_t rowLen = std::size_t(width_) * channels_;
+        std::vector<unsigned char> buffer(rowLen * bytes);
         for (int i = 0; i < height_; ++i) {
-            for (int j = 0; j < width_; ++j) {
-                const auto& p = color_[i][j];
-                out << p[0] << ' ' << p[1] << ' ' << p[2] << ' ';
+            const int* row = rowData(i);
+            if (bytes == 1) {
+                for (std::size_t k = 0; k < rowLen; ++k) buffer[k] = (unsigned char)row[k];
+            } else {
+                for (std::size_t k = 0; k < rowLen; ++k) {
+                    buffer[2 * k] = (unsigned char)(row[k] >> 8);
+                    buffer[2 * k + 1] = (unsigned char)(row[k] & 0xff);
+                }
             }
-            out << '\n';
+            out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
         }
+        return;
     }
+
+    // pixel data
+    const std::size_t rowLen = std::size_t(width_) * channels_;
+    for (int i = 0; i < height_; ++i) {
+        const int* row = rowData(i);
+        for (std::size_t k = 0; k < rowLen; ++k) {
+            out << row[k] << ' ';
+        }
+        out << '\n';
+    }
+}
+
+/**
+ * @brief Switch the format write() uses.
+ * @throws runtime_error for a float image, or one QOI cannot hold.
+ */
+void Image::setFormat(Format format) {
+    if (isFloat()) throw std::runtime_error("Float images can only be written as PFM");
+    if (format == QoiFormat) {
+        if (channels_ > 4 || maxValue_ > 255)
+            throw std::runtime_error("QOI holds up to 4 channels of 8-bit samples");
+        if (maxValue_ < 255)
+            for (auto& v : pixels_) v = (v * 255 + maxValue_ / 2) / maxValue_;
+        maxValue_ = 255;
+        magic_ = "qoif";
+        tupleType_.clear();
+        comments_.clear();
+        return;
+    }
+    PnmHeader header;
+    header.magic = magic_ == "qoif" ? "P7" : magic_;
+    header.tupleType = tupleType_;
+    header.depth = channels_;
+    header = header.converted(format != AsciiFormat, format == PamFormat);
+    magic_ = header.magic;
+    tupleType_ = header.tupleType;
+}
+
+bool Image::convertTo(Format format) {
+    if (isFloat()) return false;
+    setFormat(format);
+    return true;
+}
+
+bool Image::parseFormat(const std::string& name, Format& format) {
+    if      (name == "ascii")  format = AsciiFormat;
+    else if (name == "binary") format = BinaryFormat;
+    else if (name == "pam")    format = PamFormat;
+    else if (name == "qoi")    format = QoiFormat;
+    else return false;
+    return true;
+}
+
+std::string Image::extensionFor(Format format, int channels) {
+    if (format == QoiFormat) return ".qoi";
+    if (format == PamFormat || (channels != 1 && channels != 3)) return ".pam";
+    return channels == 1 ? ".pgm" : ".ppm";
 }
 
 int Image::getWidth()  const { return width_;  }
 int Image::getHeight() const { return height_; }
-bool Image::isColor()  const { return isColor_;  }
+bool Image::isColor()  const { return channels_ >= 3; }
+int Image::getChannels() const { return channels_; }
+int Image::getMaxValue() const { return maxValue_; }
+bool Image::isFloat() const { return scale_ != 0; }
+
+const int* Image::rowData(int r) const {
+    return pixels_.data() + std::size_t(r) * width_ * channels_;
+}
+
+int* Image::rowData(int r) {
+    return pixels_.data() + std::size_t(r) * width_ * channels_;
+}
 
 /**
  * @brief Access grayscale pixel (if P2) or convert color to gray via average (for energy).
  */
 int Image::grayValue(int r, int c) const {
-    if (!isColor_) return gray_[r][c];
-    auto p = color_[r][c];
-    return (p[0] + p[1] + p[2]) / 3;
+    const int* p = rowData(r) + std::size_t(c) * channels_;
+    return visitChannels([&](auto channels) { return grayPixel(p, channels); });
 }
 
 /**
- * @brief Remove one vertical seam.
+ * @brief Remove one vertical seam by compacting rows in place.
  */
 void Image::removeSeam(const std::vector<int>& seam) {
-    if (!isColor_) {
-        for (int i = 0; i < height_; ++i)
-            gray_[i].erase(gray_[i].begin() + seam[i]);
-    } else {
-        for (int i = 0; i < height_; ++i)
-            color_[i].erase(color_[i].begin() + seam[i]);
-    }
+    const std::size_t dst = visitChannels([&](auto channels) {
+        const std::size_t C = channels, rowLen = std::size_t(width_) * C;
+        int* data = pixels_.data();
+        std::size_t dst = 0;
+        for (int i = 0; i < height_; ++i) {
+            const int* src = data + i * rowLen;
+            const std::size_t cut = std::size_t(seam[i]) * C;
+            // destination never overtakes the source, so memmove is safe
+            std::memmove(data + dst, src, cut * sizeof(int));
+            std::memmove(data + dst + cut, src + cut + C, (rowLen - cut - C) * sizeof(int));
+            dst += rowLen - C;
+        }
+        return dst;
+    });
     --width_;
+    pixels_.resize(dst);
 }
 
 /**
  * @brief Transpose image (rows <-> cols).
  */
 void Image::transpose() {
-    if (!isColor_) {
-        std::vector<std::vector<int>> tmp(width_, std::vector<int>(height_));
-        for (int i = 0; i < height_; ++i)
-            for (int j = 0; j < width_; ++j)
-                tmp[j][i] = gray_[i][j];
-        gray_.swap(tmp);
-    } else {
-        std::vector<std::vector<std::array<int,3>>> tmp(
-            width_, std::vector<std::array<int,3>>(height_));
-        for (int i = 0; i < height_; ++i)
-            for (int j = 0; j < width_; ++j)
-                tmp[j][i] = color_[i][j];
-        color_.swap(tmp);
-    }
+    std::vector<int> tmp(pixels_.size());
+    Kernels::get().transpose(pixels_.data(), tmp.data(), height_, width_, channels_);
+    pixels_.swap(tmp);
     std::swap(width_, height_);
 }
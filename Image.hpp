@@ -1,10 +1,36 @@
 #include <vector>
 #include <string>
+#include <array>
+#include <iosfwd>
+#include <type_traits>
 #include <cstdlib>
+#include <cstring>
 
 #ifndef IMAGE_HPP
 #define IMAGE_HPP
 
+/**
+ * @brief Gray value of a pixel: the integer mean of its channels samples.
+ *        channels is an int or, from Image::visitChannels, a compile-time
+ *        constant that lets the loop unroll.
+ */
+template <typename Channels>
+inline int grayPixel(const int* p, Channels channels) {
+    const int C = channels;
+    int sum = 0;
+    for (int c = 0; c < C; ++c) sum += p[c];
+    return sum / C;
+}
+
+/**
+ * @brief Value of a float sample, stored as its bit pattern in a float image.
+ */
+inline float sampleFloat(int bits) {
+    float f;
+    std::memcpy(&f, &bits, sizeof f);
+    return f;
+}
+
 /**
  * @class Image
  * @brief Represents a image, preserving comments.
@@ -12,26 +38,90 @@
 class Image {
 private:
     int width_, height_, maxValue_;
-    bool isColor_;
+    int channels_;                                                  // 1 (P2), 3 (P3) or any (P7)
+    std::string magic_, tupleType_;                                 // input format, see PnmHeader
+    double scale_ = 0;                                              // PFM scale; 0 for integer images
+    int colorspace_ = 0;                                            // QOI colorspace byte
     std::vector<std::string> comments_;
-    std::vector<std::vector<int>> gray_;                           // grayscale pixels
-    std::vector<std::vector<std::array<int,3>>> color_;             // color pixels [row][col]
+    std::vector<int> pixels_;                                       // row-major, channels_ ints per pixel;
+                                                                    // float bit patterns for PFM
 
 public:
     /**
-     * @brief Load a P2 PGM, capturing comment lines.
+     * @brief Output formats an image can be converted to with setFormat():
+     *        ASCII P2/P3, binary P5/P6 (either P7 for channel counts PGM and
+     *        PPM cannot hold), PAM (P7) or QOI.
+     */
+    enum Format { AsciiFormat, BinaryFormat, PamFormat, QoiFormat };
+
+    /**
+     * @brief Load a P2 PGM, capturing comment lines. Gzip compressed files
+     *        (e.g. .ppm.gz) are recognized by their magic and inflated while
+     *        they are parsed.
      * @param filename Path to input PGM file.
      * @throws runtime_error on I/O or format error.
      */
     explicit Image(const std::string& filename); 
 
+    /**
+     * @brief Parse a P2, P3, P5, P6, P7, PF or Pf image, or a QOI image
+     *        (magic "qoif"), from an already open stream. Binary formats need
+     *        a stream opened in binary mode.
+     * @param in Input stream positioned at the magic number.
+     * @throws runtime_error on format error.
+     */
+    explicit Image(std::istream& in);
+
+    /**
+     * @brief Create a zero-filled image, e.g. to decode a raw plane into.
+     * @param channels 1 (written as P2), 3 (written as P3), or any other
+     *                 count (written as P7, with an alpha tuple type for 2 and 4).
+     * @throws runtime_error on invalid dimensions.
+     */
+    Image(int width, int height, int channels, int maxValue);
+
     /**
      * @brief Write image to a P2 PGM, presvers comments and matching whitespace.
+     *        A filename ending in ".gz" is written gzip compressed.
      * @param filename Path to output file.
      * @throws runtime_error on I/O error.
      */
     void write(const std::string& filename) const; 
 
+    /**
+     * @brief Write image to an already open stream.
+     * @param out Output stream.
+     */
+    void write(std::ostream& out) const;
+
+    /**
+     * @brief Write the image in format from now on instead of its input
+     *        format. Comments are kept except in QOI, which holds none; QOI
+     *        needs 8-bit samples, and lower max values are scaled to 255.
+     * @throws runtime_error for a float image, or one QOI cannot hold.
+     */
+    void setFormat(Format format);
+
+    /**
+     * @brief setFormat() for images that have an integer format to go to;
+     *        float images stay PFM, as --format leaves them.
+     * @return false, with the image unchanged, for a float image.
+     * @throws runtime_error for an image QOI cannot hold.
+     */
+    bool convertTo(Format format);
+
+    /**
+     * @brief Parse "ascii", "binary", "pam" or "qoi".
+     * @return false for anything else.
+     */
+    static bool parseFormat(const std::string& name, Format& format);
+
+    /**
+     * @brief File extension of an image of channels samples per pixel written
+     *        in format: .pgm, .ppm, .pam or .qoi.
+     */
+    static std::string extensionFor(Format format, int channels);
+
     /** @brief Get image width. */
     int getWidth() const; 
 
@@ -40,6 +130,41 @@ public:
 
     bool isColor()  const;
 
+    /** @brief Ints per pixel: 1 for gray, 3 for color, any for PAM. */
+    int getChannels() const;
+
+    /** @brief Largest sample value; 1 for float images. */
+    int getMaxValue() const;
+
+    /**
+     * @brief True for a PFM image. Its samples are floats kept as their bit
+     *        patterns, see sampleFloat(): moving pixels around (seam removal,
+     *        transpose) is exact, while grayValue() and getPixel() do not apply.
+     */
+    bool isFloat() const;
+
+    /** @brief Pointer to row r (width * channels contiguous ints). */
+    const int* rowData(int r) const;
+
+    /** @brief Writable pointer to row r. */
+    int* rowData(int r);
+
+    /**
+     * @brief Call fn(std::integral_constant<int, C>{}) with C the channel count,
+     *        so per-pixel loops inside fn are compiled for one pixel format.
+     *        Counts above 4 are passed as a plain int.
+     */
+    template <typename Fn>
+    decltype(auto) visitChannels(Fn&& fn) const {
+        switch (channels_) {
+        case 1:  return fn(std::integral_constant<int, 1>{});
+        case 2:  return fn(std::integral_constant<int, 2>{});
+        case 3:  return fn(std::integral_constant<int, 3>{});
+        case 4:  return fn(std::integral_constant<int, 4>{});
+        default: return fn(int(channels_));
+        }
+    }
+
     /**
      * @brief Access grayscale pixel (if P2) or convert color to gray via average (for energy).
      */
@@ -0,0 +1,138 @@
+#include <string>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(__x86_64__)
+#include <cpuid.h>
+#endif
+#include "Kernels.hpp"
+
+namespace {
+
+/**
+ * @brief Query cpuid and XCR0: the CPU must implement an extension and the
+ *        OS must save the corresponding register state.
+ */
+Kernels::Isa detectCpu() {
+#if defined(__x86_64__) || defined(_M_X64)
+    unsigned regs1[4] = {}, regs7[4] = {};
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 0);
+    int maxLeaf = r[0];
+    __cpuid(r, 1);
+    for (int k = 0; k < 4; ++k) regs1[k] = unsigned(r[k]);
+    if (maxLeaf >= 7) {
+        __cpuidex(r, 7, 0);
+        for (int k = 0; k < 4; ++k) regs7[k] = unsigned(r[k]);
+    }
+#else
+    unsigned maxLeaf = __get_cpuid_max(0, nullptr);
+    __cpuid(1, regs1[0], regs1[1], regs1[2], regs1[3]);
+    if (maxLeaf >= 7) __cpuid_count(7, 0, regs7[0], regs7[1], regs7[2], regs7[3]);
+#endif
+    const bool osxsave = regs1[2] & (1u << 27);
+    if (!osxsave) return Kernels::Baseline;
+#if defined(_MSC_VER)
+    unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    unsigned long long xcr0 = (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+    const bool ymmState = (xcr0 & 0x6) == 0x6;    // XMM and YMM
+    const bool zmmState = (xcr0 & 0xe6) == 0xe6;  // plus opmask and ZMM
+    const bool avx2 = regs7[1] & (1u << 5);
+    const bool avx512f = regs7[1] & (1u << 16);
+    const bool avx512bw = regs7[1] & (1u << 30);
+    if (avx512f && avx512bw && avx2 && zmmState) return Kernels::AVX512;
+    if (avx2 && ymmState) return Kernels::AVX2;
+#endif
+    return Kernels::Baseline;
+}
+
+const KernelTable* tableFor(Kernels::Isa isa) {
+    switch (isa) {
+        case Kernels::AVX512: return avx512Kernels();
+        case Kernels::AVX2:   return avx2Kernels();
+        default:              return baselineKernels();
+    }
+}
+
+std::atomic<int> activeIsa{-1};
+
+/**
+ * @brief First-use selection: detected level, lowered by SEAMCARVE_ISA.
+ */
+int initialIsa() {
+    Kernels::Isa isa = Kernels::detect();
+    if (const char* env = std::getenv("SEAMCARVE_ISA")) {
+        Kernels::Isa forced;
+        if (!Kernels::parseIsa(env, forced)) {
+            std::cerr << "Warning: unknown SEAMCARVE_ISA '" << env << "', using "
+                      << Kernels::isaName(isa) << "\n";
+        } else if (forced > isa) {
+            std::cerr << "Warning: SEAMCARVE_ISA=" << env << " not supported here, using "
+                      << Kernels::isaName(isa) << "\n";
+        } else {
+            isa = forced;
+        }
+    }
+    return isa;
+}
+
+} // namespace
+
+Kernels::Isa Kernels::detect() {
+    static const Isa detected = [] {
+        Isa isa = detectCpu();
+        while (isa > Baseline && !tableFor(isa)) isa = Isa(isa - 1);
+        return isa;
+    }();
+    return detected;
+}
+
+Kernels::Isa Kernels::active() {
+    int isa = activeIsa.load(std::memory_order_acquire);
+    if (isa < 0) {
+        int expected = -1;
+        activeIsa.compare_exchange_strong(expected, initialIsa());
+        isa = activeIsa.load(std::memory_order_acquire);
+    }
+    return Isa(isa);
+}
+
+const KernelTable& Kernels::get() {
+    return *tableFor(active());
+}
+
+bool Kernels::select(Isa isa) {
+    if (isa < Baseline || isa >= IsaCount || isa > detect()) return false;
+    activeIsa.store(isa, std::memory_order_release);
+    return true;
+}
+
+const char* Kernels::isaName(Isa isa) {
+    switch (isa) {
+        case AVX512: return "avx512";
+        case AVX2:   return "avx2";
+        default:     return "baseline";
+    }
+}
+
+bool Kernels::parseIsa(const std::string& name, Isa& isa) {
+    for (int i = Baseline; i < IsaCount; ++i) {
+        if (name == isaName(Isa(i))) {
+            isa = Isa(i);
+            return true;
+        }
+    }
+    if (name == "sse2") {
+        isa = Baseline;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,105 @@
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+/**
+ * @struct KernelTable
+ * @brief Inner loops of the carver, compiled once per instruction set.
+ *
+ * All rows are contiguous int arrays; images are interleaved with
+ * `channels` ints per pixel.
+ */
+struct KernelTable {
+    const char* name;
+
+    /** @brief dst[j] = average of the channels of pixel j (integer division). */
+    void (*grayRow)(const int* src, int* dst, int width, int channels);
+
+    /**
+     * @brief Sum of absolute differences to the 4-neighbourhood of each pixel
+     *        of cur. Pass cur as up/down on the first/last row.
+     */
+    void (*energyRow)(const int* up, const int* cur, const int* down, int* out, int width);
+
+    /**
+     * @brief One row of the seam DP for columns [first, last):
+     *        out[j] = energy[j] + min(prev[j-1], prev[j], prev[j+1]).
+     */
+    void (*costRow)(const int* prev, const int* energy, int* out, int first, int last, int width);
+
+    /** @brief costRow with 64-bit costs, for seams whose cost can exceed an int. */
+    void (*costRowWide)(const long long* prev, const int* energy, long long* out,
+                        int first, int last, int width);
+
+    /** @brief dst (width x height) = transpose of src (height x width). */
+    void (*transpose)(const int* src, int* dst, int height, int width, int channels);
+
+    /** @brief grayRow into 16 bits; samples must not exceed 65535. */
+    void (*grayRow16)(const int* src, std::uint16_t* dst, int width, int channels);
+
+    /**
+     * @brief energyRow on 16-bit gray rows: differences are taken at twice
+     *        the lanes per register, then widened to int for the sums.
+     */
+    void (*energyRow16)(const std::uint16_t* up, const std::uint16_t* cur,
+                        const std::uint16_t* down, int* out, int width);
+
+    /** @brief transpose of a 16-bit plane. */
+    void (*transpose16)(const std::uint16_t* src, std::uint16_t* dst, int height, int width);
+
+    /** @brief grayRow of a float image, whose ints are float bit patterns. */
+    void (*grayRowF)(const int* src, float* dst, int width, int channels);
+
+    /** @brief energyRow on float gray rows. */
+    void (*energyRowF)(const float* up, const float* cur, const float* down, float* out, int width);
+
+    /** @brief costRow with float energies and costs. */
+    void (*costRowF)(const float* prev, const float* energy, float* out, int first, int last, int width);
+};
+
+/**
+ * @class Kernels
+ * @brief Selects the best KernelTable for the running CPU.
+ *
+ * The level is detected with cpuid on first use. The environment variable
+ * SEAMCARVE_ISA (baseline, avx2, avx512) forces a lower level for testing;
+ * requests above what the CPU supports fall back to the detected level.
+ */
+class Kernels {
+public:
+    enum Isa { Baseline, AVX2, AVX512, IsaCount };
+
+    /** @brief Active kernel table. */
+    static const KernelTable& get();
+
+    /** @brief Instruction set of the active table. */
+    static Isa active();
+
+    /** @brief Best instruction set supported by CPU, OS and this build. */
+    static Isa detect();
+
+    /**
+     * @brief Switch to another instruction set.
+     * @return false (and no change) if it is not supported here.
+     */
+    static bool select(Isa isa);
+
+    /** @brief Name of an instruction set as accepted by SEAMCARVE_ISA. */
+    static const char* isaName(Isa isa);
+
+    /**
+     * @brief Parse a name from isaName().
+     * @return false for unknown names.
+     */
+    static bool parseIsa(const std::string& name, Isa& isa);
+};
+
+// Per-instruction-set tables; nullptr when not compiled for this target.
+const KernelTable* baselineKernels();
+const KernelTable* avx2Kernels();
+const KernelTable* avx512Kernels();
+
+#endif // !KERNELS_HPP
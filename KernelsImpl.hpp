@@ -0,0 +1,292 @@
+/**
+ * @file KernelsImpl.hpp
+ * @brief Kernel bodies shared by all instruction sets, templated on a
+ *        vector wrapper from KernelsVec.hpp.
+ *
+ * Only included by Kernels_*.cpp. Deliberately free of standard library
+ * templates: anything instantiated here is compiled for the including
+ * translation unit's instruction set.
+ */
+
+#include <cstring>
+
+#ifndef KERNELSIMPL_HPP
+#define KERNELSIMPL_HPP
+
+namespace {
+
+inline int kmin(int a, int b) { return a < b ? a : b; }
+inline long long kmin(long long a, long long b) { return a < b ? a : b; }
+inline int kabs(int a) { return a < 0 ? -a : a; }
+inline float kmin(float a, float b) { return a < b ? a : b; }
+inline float kabs(float a) { return a < 0 ? -a : a; }
+
+// Float sample from its bit pattern in an int row (memcpy keeps it alias-safe).
+inline float kfloat(int bits) {
+    float f;
+    std::memcpy(&f, &bits, sizeof f);
+    return f;
+}
+
+// Integer mean of the C samples of each pixel; the channel loop unrolls.
+template <int C>
+void grayRowC(const int* src, int* dst, int width) {
+    for (int j = 0; j < width; ++j) {
+        int sum = 0;
+        for (int c = 0; c < C; ++c) sum += src[j * C + c];
+        dst[j] = sum / C;
+    }
+}
+
+template <class V>
+void grayRowT(const int* src, int* dst, int width, int channels) {
+    if (channels == 1) {
+        grayRowC<1>(src, dst, width);
+    } else if (channels == 2) {
+        grayRowC<2>(src, dst, width);
+    } else if (channels == 3) {
+        grayRowC<3>(src, dst, width);
+    } else if (channels == 4) {
+        grayRowC<4>(src, dst, width);
+    } else {
+        for (int j = 0; j < width; ++j) {
+            int sum = 0;
+            for (int c = 0; c < channels; ++c) sum += src[j * channels + c];
+            dst[j] = sum / channels;
+        }
+    }
+}
+
+template <class V>
+void grayRow16T(const int* src, std::uint16_t* dst, int width, int channels) {
+    if (channels == 1) {
+        for (int j = 0; j < width; ++j) dst[j] = (std::uint16_t)src[j];
+    } else if (channels == 3) {
+        for (int j = 0; j < width; ++j)
+            dst[j] = (std::uint16_t)((src[3 * j] + src[3 * j + 1] + src[3 * j + 2]) / 3);
+    } else {
+        for (int j = 0; j < width; ++j) {
+            int sum = 0;
+            for (int c = 0; c < channels; ++c) sum += src[j * channels + c];
+            dst[j] = (std::uint16_t)(sum / channels);
+        }
+    }
+}
+
+template <class V>
+void energyRow16T(const std::uint16_t* up, const std::uint16_t* cur, const std::uint16_t* down,
+                  int* out, int width) {
+    const int last = width - 1;
+    if (width == 1) {
+        out[0] = kabs(cur[0] - up[0]) + kabs(cur[0] - down[0]);
+        return;
+    }
+    out[0] = kabs(cur[0] - up[0]) + kabs(cur[0] - down[0]) + kabs(cur[0] - cur[1]);
+    int j = 1;
+    for (; j + V::lanes16 <= last; j += V::lanes16) {
+        auto v = V::load16(cur + j);
+        auto u = V::absdiff16(v, V::load16(up + j)), d = V::absdiff16(v, V::load16(down + j));
+        auto l = V::absdiff16(v, V::load16(cur + j - 1)), r = V::absdiff16(v, V::load16(cur + j + 1));
+        // four differences of up to 65535 need more than 16 bits
+        V::store(out + j, V::add(V::add(V::widenLo(u), V::widenLo(d)),
+                                 V::add(V::widenLo(l), V::widenLo(r))));
+        V::store(out + j + V::lanes, V::add(V::add(V::widenHi(u), V::widenHi(d)),
+                                            V::add(V::widenHi(l), V::widenHi(r))));
+    }
+    for (; j < last; ++j) {
+        int v = cur[j];
+        out[j] = kabs(v - up[j]) + kabs(v - down[j]) + kabs(v - cur[j - 1]) + kabs(v - cur[j + 1]);
+    }
+    out[last] = kabs(cur[last] - up[last]) + kabs(cur[last] - down[last])
+              + kabs(cur[last] - cur[last - 1]);
+}
+
+template <class V>
+void energyRowT(const int* up, const int* cur, const int* down, int* out, int width) {
+    const int last = width - 1;
+    if (width == 1) {
+        out[0] = kabs(cur[0] - up[0]) + kabs(cur[0] - down[0]);
+        return;
+    }
+    out[0] = kabs(cur[0] - up[0]) + kabs(cur[0] - down[0]) + kabs(cur[0] - cur[1]);
+    int j = 1;
+    for (; j + V::lanes <= last; j += V::lanes) {
+        auto v = V::load(cur + j);
+        auto vertical = V::add(V::abs(V::sub(v, V::load(up + j))),
+                               V::abs(V::sub(v, V::load(down + j))));
+        auto horizontal = V::add(V::abs(V::sub(v, V::load(cur + j - 1))),
+                                 V::abs(V::sub(v, V::load(cur + j + 1))));
+        V::store(out + j, V::add(vertical, horizontal));
+    }
+    for (; j < last; ++j) {
+        int v = cur[j];
+        out[j] = kabs(v - up[j]) + kabs(v - down[j]) + kabs(v - cur[j - 1]) + kabs(v - cur[j + 1]);
+    }
+    out[last] = kabs(cur[last] - up[last]) + kabs(cur[last] - down[last])
+              + kabs(cur[last] - cur[last - 1]);
+}
+
+template <class V>
+void costRowT(const int* prev, const int* energy, int* out, int first, int last, int width) {
+    int j = first;
+    if (j == 0 && j < last) {
+        out[0] = energy[0] + (width > 1 ? kmin(prev[0], prev[1]) : prev[0]);
+        j = 1;
+    }
+    int interiorEnd = kmin(last, width - 1);
+    for (; j + V::lanes <= interiorEnd; j += V::lanes) {
+        auto best = V::min(V::min(V::load(prev + j - 1), V::load(prev + j)), V::load(prev + j + 1));
+        V::store(out + j, V::add(V::load(energy + j), best));
+    }
+    for (; j < interiorEnd; ++j)
+        out[j] = energy[j] + kmin(kmin(prev[j - 1], prev[j]), prev[j + 1]);
+    if (last == width && width > 1)
+        out[width - 1] = energy[width - 1] + kmin(prev[width - 2], prev[width - 1]);
+}
+
+// No 64-bit lane wrapper: plain loops, vectorized by the compiler for the
+// including translation unit's instruction set.
+template <class V>
+void costRowWideT(const long long* prev, const int* energy, long long* out,
+                  int first, int last, int width) {
+    int j = first;
+    if (j == 0 && j < last) {
+        out[0] = energy[0] + (width > 1 ? kmin(prev[0], prev[1]) : prev[0]);
+        j = 1;
+    }
+    int interiorEnd = kmin(last, width - 1);
+    for (; j < interiorEnd; ++j)
+        out[j] = energy[j] + kmin(kmin(prev[j - 1], prev[j]), prev[j + 1]);
+    if (last == width && width > 1)
+        out[width - 1] = energy[width - 1] + kmin(prev[width - 2], prev[width - 1]);
+}
+
+// Float rows mirror the int ones; the scalar edges group the four
+// differences like the vector lanes so every instruction set rounds alike.
+template <class V>
+void grayRowFT(const int* src, float* dst, int width, int channels) {
+    if (channels == 1) {
+        for (int j = 0; j < width; ++j) dst[j] = kfloat(src[j]);
+    } else if (channels == 3) {
+        for (int j = 0; j < width; ++j)
+            dst[j] = (kfloat(src[3 * j]) + kfloat(src[3 * j + 1]) + kfloat(src[3 * j + 2])) / 3;
+    } else {
+        for (int j = 0; j < width; ++j) {
+            float sum = 0;
+            for (int c = 0; c < channels; ++c) sum += kfloat(src[j * channels + c]);
+            dst[j] = sum / channels;
+        }
+    }
+}
+
+template <class V>
+void energyRowFT(const float* up, const float* cur, const float* down, float* out, int width) {
+    const int last = width - 1;
+    if (width == 1) {
+        out[0] = kabs(cur[0] - up[0]) + kabs(cur[0] - down[0]);
+        return;
+    }
+    out[0] = (kabs(cur[0] - up[0]) + kabs(cur[0] - down[0])) + kabs(cur[0] - cur[1]);
+    int j = 1;
+    for (; j + V::lanes <= last; j += V::lanes) {
+        auto v = V::loadF(cur + j);
+        auto vertical = V::addF(V::absF(V::subF(v, V::loadF(up + j))),
+                                V::absF(V::subF(v, V::loadF(down + j))));
+        auto horizontal = V::addF(V::absF(V::subF(v, V::loadF(cur + j - 1))),
+                                  V::absF(V::subF(v, V::loadF(cur + j + 1))));
+        V::storeF(out + j, V::addF(vertical, horizontal));
+    }
+    for (; j < last; ++j) {
+        float v = cur[j];
+        out[j] = (kabs(v - up[j]) + kabs(v - down[j])) + (kabs(v - cur[j - 1]) + kabs(v - cur[j + 1]));
+    }
+    out[last] = (kabs(cur[last] - up[last]) + kabs(cur[last] - down[last]))
+              + kabs(cur[last] - cur[last - 1]);
+}
+
+template <class V>
+void costRowFT(const float* prev, const float* energy, float* out, int first, int last, int width) {
+    int j = first;
+    if (j == 0 && j < last) {
+        out[0] = energy[0] + (width > 1 ? kmin(prev[0], prev[1]) : prev[0]);
+        j = 1;
+    }
+    int interiorEnd = kmin(last, width - 1);
+    for (; j + V::lanes <= interiorEnd; j += V::lanes) {
+        auto best = V::minF(V::minF(V::loadF(prev + j - 1), V::loadF(prev + j)), V::loadF(prev + j + 1));
+        V::storeF(out + j, V::addF(V::loadF(energy + j), best));
+    }
+    for (; j < interiorEnd; ++j)
+        out[j] = energy[j] + kmin(kmin(prev[j - 1], prev[j]), prev[j + 1]);
+    if (last == width && width > 1)
+        out[width - 1] = energy[width - 1] + kmin(prev[width - 2], prev[width - 1]);
+}
+
+/**
+ * @brief Pixel by pixel transpose of rows [i, iEnd) and columns [jb, jEnd)
+ *        of one block, C ints per pixel (0: `channels`, known at run time).
+ */
+template <int C>
+void transposeRows(const int* src, int* dst, long long h, long long w, int channels,
+                   int i, int iEnd, int jb, int jEnd) {
+    const long long n = C ? C : channels;
+    for (; i < iEnd; ++i)
+        for (int j = jb; j < jEnd; ++j)
+            for (long long c = 0; c < n; ++c)
+                dst[(j * h + i) * n + c] = src[(i * w + j) * n + c];
+}
+
+template <class V>
+void transposeT(const int* src, int* dst, int height, int width, int channels) {
+    const long long h = height, w = width;
+    const int block = 64; // cache block in pixels per side
+    for (int ib = 0; ib < height; ib += block) {
+        const int iEnd = kmin(ib + block, height);
+        for (int jb = 0; jb < width; jb += block) {
+            const int jEnd = kmin(jb + block, width);
+            int i = ib;
+            if (channels == 1) {
+                for (; i + V::tile <= iEnd; i += V::tile) {
+                    int j = jb;
+                    for (; j + V::tile <= jEnd; j += V::tile)
+                        V::transposeTile(src + i * w + j, w, dst + j * h + i, h);
+                    for (; j < jEnd; ++j)
+                        for (int ii = i; ii < i + V::tile; ++ii) dst[j * h + ii] = src[ii * w + j];
+                }
+                transposeRows<1>(src, dst, h, w, 1, i, iEnd, jb, jEnd);
+            } else if (channels == 3) {
+                transposeRows<3>(src, dst, h, w, 3, i, iEnd, jb, jEnd);
+            } else if (channels == 4) {
+                transposeRows<4>(src, dst, h, w, 4, i, iEnd, jb, jEnd);
+            } else {
+                transposeRows<0>(src, dst, h, w, channels, i, iEnd, jb, jEnd);
+            }
+        }
+    }
+}
+
+template <class V>
+void transpose16T(const std::uint16_t* src, std::uint16_t* dst, int height, int width) {
+    const long long h = height, w = width;
+    const int block = 64; // cache block in pixels per side
+    for (int ib = 0; ib < height; ib += block) {
+        const int iEnd = kmin(ib + block, height);
+        for (int jb = 0; jb < width; jb += block) {
+            const int jEnd = kmin(jb + block, width);
+            int i = ib;
+            for (; i + V::tile16 <= iEnd; i += V::tile16) {
+                int j = jb;
+                for (; j + V::tile16 <= jEnd; j += V::tile16)
+                    V::transposeTile16(src + i * w + j, w, dst + j * h + i, h);
+                for (; j < jEnd; ++j)
+                    for (int ii = i; ii < i + V::tile16; ++ii) dst[j * h + ii] = src[ii * w + j];
+            }
+            for (; i < iEnd; ++i)
+                for (int j = jb; j < jEnd; ++j) dst[j * h + i] = src[i * w + j];
+        }
+    }
+}
+
+} // namespace
+
+#endif // !KERNELSIMPL_HPP
@@ -0,0 +1,253 @@
+/**
+ * @file KernelsVec.hpp
+ * @brief SIMD wrappers used by KernelsImpl.hpp.
+ *
+ * Included by the Kernels_*.cpp translation units after they enabled their
+ * instruction set; each one defines SEAMCARVE_VEC_* for the wrappers it
+ * needs. Everything has internal linkage so no code compiled for a wider
+ * instruction set can leak into the baseline through the linker.
+ */
+
+#ifndef KERNELSVEC_HPP
+#define KERNELSVEC_HPP
+
+namespace {
+
+#if defined(SEAMCARVE_VEC_SSE2) || defined(SEAMCARVE_VEC_AVX2)
+/**
+ * @brief Transpose an 8x8 tile of 16-bit samples with SSE2 unpacks; shared
+ *        by every x86 wrapper.
+ */
+inline void transposeTile16Sse2(const std::uint16_t* src, long long srcStride,
+                                std::uint16_t* dst, long long dstStride) {
+    __m128i r[8], a[8];
+    for (int k = 0; k < 8; ++k)
+        r[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + k * srcStride));
+    for (int k = 0; k < 8; k += 2) {
+        a[k]     = _mm_unpacklo_epi16(r[k], r[k + 1]);
+        a[k + 1] = _mm_unpackhi_epi16(r[k], r[k + 1]);
+    }
+    // a[0..3]: columns 0-3 and 4-7 of rows 0-3; a[4..7] the same for rows 4-7
+    for (int k = 0; k < 8; k += 4) {
+        r[k]     = _mm_unpacklo_epi32(a[k],     a[k + 2]);
+        r[k + 1] = _mm_unpackhi_epi32(a[k],     a[k + 2]);
+        r[k + 2] = _mm_unpacklo_epi32(a[k + 1], a[k + 3]);
+        r[k + 3] = _mm_unpackhi_epi32(a[k + 1], a[k + 3]);
+    }
+    for (int k = 0; k < 4; ++k) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * k * dstStride),
+                         _mm_unpacklo_epi64(r[k], r[k + 4]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (2 * k + 1) * dstStride),
+                         _mm_unpackhi_epi64(r[k], r[k + 4]));
+    }
+}
+#endif
+
+/**
+ * @struct VecScalar
+ * @brief One-lane fallback for targets without a SIMD wrapper.
+ */
+struct VecScalar {
+    using T = int;
+    static const int lanes = 1;
+    static const int tile = 1;
+
+    // 16-bit lanes: twice as many as 32-bit ones per register
+    struct H { int lo, hi; };
+    static const int lanes16 = 2;
+    static const int tile16 = 1;
+
+    static T load(const int* p) { return *p; }
+    static void store(int* p, T v) { *p = v; }
+    static T add(T a, T b) { return a + b; }
+    static T sub(T a, T b) { return a - b; }
+    static T min(T a, T b) { return a < b ? a : b; }
+    static T abs(T a) { return a < 0 ? -a : a; }
+
+    using F = float;
+    static F loadF(const float* p) { return *p; }
+    static void storeF(float* p, F v) { *p = v; }
+    static F addF(F a, F b) { return a + b; }
+    static F subF(F a, F b) { return a - b; }
+    // same operand order as minps: b unless a < b, so NaNs resolve alike
+    static F minF(F a, F b) { return a < b ? a : b; }
+    static F absF(F a) { return a < 0 ? -a : a; }
+
+    static H load16(const std::uint16_t* p) { return { p[0], p[1] }; }
+    static H absdiff16(H a, H b) { return { abs(a.lo - b.lo), abs(a.hi - b.hi) }; }
+    static T widenLo(H v) { return v.lo; }
+    static T widenHi(H v) { return v.hi; }
+
+    static void transposeTile(const int* src, long long, int* dst, long long) { *dst = *src; }
+    static void transposeTile16(const std::uint16_t* src, long long, std::uint16_t* dst, long long) {
+        *dst = *src;
+    }
+};
+
+#if defined(SEAMCARVE_VEC_SSE2)
+/**
+ * @struct VecSse2
+ * @brief 4 x int32. SSE2 lacks pabsd and pminsd, so both are emulated.
+ */
+struct VecSse2 {
+    using T = __m128i;
+    static const int lanes = 4;
+    static const int tile = 4;
+
+    using H = __m128i;
+    static const int lanes16 = 8;
+    static const int tile16 = 8;
+
+    static T load(const int* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(int* p, T v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static T add(T a, T b) { return _mm_add_epi32(a, b); }
+    static T sub(T a, T b) { return _mm_sub_epi32(a, b); }
+    static T min(T a, T b) {
+        __m128i gt = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+    }
+    static T abs(T a) {
+        __m128i sign = _mm_srai_epi32(a, 31);
+        return _mm_sub_epi32(_mm_xor_si128(a, sign), sign);
+    }
+
+    using F = __m128;
+    static F loadF(const float* p) { return _mm_loadu_ps(p); }
+    static void storeF(float* p, F v) { _mm_storeu_ps(p, v); }
+    static F addF(F a, F b) { return _mm_add_ps(a, b); }
+    static F subF(F a, F b) { return _mm_sub_ps(a, b); }
+    static F minF(F a, F b) { return _mm_min_ps(a, b); }
+    static F absF(F a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+    static H load16(const std::uint16_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    // one of the two saturating differences is zero
+    static H absdiff16(H a, H b) { return _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a)); }
+    static T widenLo(H v) { return _mm_unpacklo_epi16(v, _mm_setzero_si128()); }
+    static T widenHi(H v) { return _mm_unpackhi_epi16(v, _mm_setzero_si128()); }
+
+    static void transposeTile(const int* src, long long srcStride, int* dst, long long dstStride) {
+        __m128i r0 = load(src), r1 = load(src + srcStride);
+        __m128i r2 = load(src + 2 * srcStride), r3 = load(src + 3 * srcStride);
+        __m128i t0 = _mm_unpacklo_epi32(r0, r1), t1 = _mm_unpacklo_epi32(r2, r3);
+        __m128i t2 = _mm_unpackhi_epi32(r0, r1), t3 = _mm_unpackhi_epi32(r2, r3);
+        store(dst,                 _mm_unpacklo_epi64(t0, t1));
+        store(dst + dstStride,     _mm_unpackhi_epi64(t0, t1));
+        store(dst + 2 * dstStride, _mm_unpacklo_epi64(t2, t3));
+        store(dst + 3 * dstStride, _mm_unpackhi_epi64(t2, t3));
+    }
+
+    static void transposeTile16(const std::uint16_t* src, long long srcStride,
+                                std::uint16_t* dst, long long dstStride) {
+        transposeTile16Sse2(src, srcStride, dst, dstStride);
+    }
+};
+#endif
+
+#if defined(SEAMCARVE_VEC_AVX2)
+/**
+ * @struct VecAvx2
+ * @brief 8 x int32.
+ */
+struct VecAvx2 {
+    using T = __m256i;
+    static const int lanes = 8;
+    static const int tile = 8;
+
+    using H = __m256i;
+    static const int lanes16 = 16;
+    static const int tile16 = 8;
+
+    static T load(const int* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(int* p, T v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static T add(T a, T b) { return _mm256_add_epi32(a, b); }
+    static T sub(T a, T b) { return _mm256_sub_epi32(a, b); }
+    static T min(T a, T b) { return _mm256_min_epi32(a, b); }
+    static T abs(T a) { return _mm256_abs_epi32(a); }
+
+    using F = __m256;
+    static F loadF(const float* p) { return _mm256_loadu_ps(p); }
+    static void storeF(float* p, F v) { _mm256_storeu_ps(p, v); }
+    static F addF(F a, F b) { return _mm256_add_ps(a, b); }
+    static F subF(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F minF(F a, F b) { return _mm256_min_ps(a, b); }
+    static F absF(F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+
+    static H load16(const std::uint16_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static H absdiff16(H a, H b) { return _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a)); }
+    static T widenLo(H v) { return _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v)); }
+    static T widenHi(H v) { return _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1)); }
+
+    static void transposeTile(const int* src, long long srcStride, int* dst, long long dstStride) {
+        __m256i r[8], t[8];
+        for (int k = 0; k < 8; ++k) r[k] = load(src + k * srcStride);
+        for (int k = 0; k < 8; k += 2) {
+            t[k]     = _mm256_unpacklo_epi32(r[k], r[k + 1]);
+            t[k + 1] = _mm256_unpackhi_epi32(r[k], r[k + 1]);
+        }
+        for (int k = 0; k < 8; k += 4) {
+            r[k]     = _mm256_unpacklo_epi64(t[k],     t[k + 2]);
+            r[k + 1] = _mm256_unpackhi_epi64(t[k],     t[k + 2]);
+            r[k + 2] = _mm256_unpacklo_epi64(t[k + 1], t[k + 3]);
+            r[k + 3] = _mm256_unpackhi_epi64(t[k + 1], t[k + 3]);
+        }
+        for (int k = 0; k < 4; ++k) {
+            store(dst + k * dstStride,       _mm256_permute2x128_si256(r[k], r[k + 4], 0x20));
+            store(dst + (k + 4) * dstStride, _mm256_permute2x128_si256(r[k], r[k + 4], 0x31));
+        }
+    }
+
+    static void transposeTile16(const std::uint16_t* src, long long srcStride,
+                                std::uint16_t* dst, long long dstStride) {
+        transposeTile16Sse2(src, srcStride, dst, dstStride);
+    }
+};
+#endif
+
+#if defined(SEAMCARVE_VEC_AVX512)
+/**
+ * @struct VecAvx512
+ * @brief 16 x int32; transposes with the AVX2 8x8 tile.
+ */
+struct VecAvx512 {
+    using T = __m512i;
+    static const int lanes = 16;
+    static const int tile = 8;
+
+    using H = __m512i;
+    static const int lanes16 = 32;
+    static const int tile16 = 8;
+
+    static T load(const int* p) { return _mm512_loadu_si512(p); }
+    static void store(int* p, T v) { _mm512_storeu_si512(p, v); }
+    static T add(T a, T b) { return _mm512_add_epi32(a, b); }
+    static T sub(T a, T b) { return _mm512_sub_epi32(a, b); }
+    static T min(T a, T b) { return _mm512_min_epi32(a, b); }
+    static T abs(T a) { return _mm512_abs_epi32(a); }
+
+    using F = __m512;
+    static F loadF(const float* p) { return _mm512_loadu_ps(p); }
+    static void storeF(float* p, F v) { _mm512_storeu_ps(p, v); }
+    static F addF(F a, F b) { return _mm512_add_ps(a, b); }
+    static F subF(F a, F b) { return _mm512_sub_ps(a, b); }
+    static F minF(F a, F b) { return _mm512_min_ps(a, b); }
+    static F absF(F a) { return _mm512_abs_ps(a); }
+
+    static H load16(const std::uint16_t* p) { return _mm512_loadu_si512(p); }
+    static H absdiff16(H a, H b) { return _mm512_or_si512(_mm512_subs_epu16(a, b), _mm512_subs_epu16(b, a)); }
+    static T widenLo(H v) { return _mm512_cvtepu16_epi32(_mm512_castsi512_si256(v)); }
+    static T widenHi(H v) { return _mm512_cvtepu16_epi32(_mm512_extracti64x4_epi64(v, 1)); }
+
+    static void transposeTile(const int* src, long long srcStride, int* dst, long long dstStride) {
+        VecAvx2::transposeTile(src, srcStride, dst, dstStride);
+    }
+
+    static void transposeTile16(const std::uint16_t* src, long long srcStride,
+                                std::uint16_t* dst, long long dstStride) {
+        transposeTile16Sse2(src, srcStride, dst, dstStride);
+    }
+};
+#endif
+
+} // namespace
+
+#endif // !KERNELSVEC_HPP
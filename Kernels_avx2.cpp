@@ -0,0 +1,44 @@
+/**
+ * @file Kernels_avx2.cpp
+ * @brief AVX2 kernels. The instruction set is enabled for this file only,
+ *        so the rest of the build keeps running on baseline CPUs.
+ */
+
+#include "Kernels.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#define SEAMCARVE_VEC_AVX2
+#include "KernelsVec.hpp"
+#include "KernelsImpl.hpp"
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+// Constant-initialized outside the target region: no wide instructions run
+// at startup on CPUs without AVX2.
+const KernelTable* avx2Kernels() {
+    static const KernelTable table = { "avx2", &grayRowT<VecAvx2>, &energyRowT<VecAvx2>,
+                                       &costRowT<VecAvx2>,
+                                       &costRowWideT<VecAvx2>, &transposeT<VecAvx2>,
+                                       &grayRow16T<VecAvx2>, &energyRow16T<VecAvx2>, &transpose16T<VecAvx2>,
+                                       &grayRowFT<VecAvx2>, &energyRowFT<VecAvx2>, &costRowFT<VecAvx2> };
+    return &table;
+}
+
+#else
+
+const KernelTable* avx2Kernels() { return nullptr; }
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ * @file Kernels_avx512.cpp
+ * @brief AVX-512 (F + BW) kernels. The instruction set is enabled for this
+ *        file only, so the rest of the build keeps running on baseline CPUs.
+ */
+
+#include "Kernels.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,avx512f,avx512bw"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,avx512f,avx512bw")
+// GCC 12's _mm512_undefined_epi32() trips a false -Wmaybe-uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#define SEAMCARVE_VEC_AVX2
+#define SEAMCARVE_VEC_AVX512
+#include "KernelsVec.hpp"
+#include "KernelsImpl.hpp"
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+// Constant-initialized outside the target region: no wide instructions run
+// at startup on CPUs without AVX-512.
+const KernelTable* avx512Kernels() {
+    static const KernelTable table = { "avx512", &grayRowT<VecAvx512>, &energyRowT<VecAvx512>,
+                                       &costRowT<VecAvx512>,
+                                       &costRowWideT<VecAvx512>, &transposeT<VecAvx512>,
+                                       &grayRow16T<VecAvx512>, &energyRow16T<VecAvx512>, &transpose16T<VecAvx512>,
+                                       &grayRowFT<VecAvx512>, &energyRowFT<VecAvx512>, &costRowFT<VecAvx512> };
+    return &table;
+}
+
+#else
+
+const KernelTable* avx512Kernels() { return nullptr; }
+
+#endif
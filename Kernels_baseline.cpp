@@ -0,0 +1,30 @@
+/**
+ * @file Kernels_baseline.cpp
+ * @brief Kernels for the baseline instruction set of the target: SSE2 on
+ *        x86-64, plain scalar code elsewhere.
+ */
+
+#include "Kernels.hpp"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SEAMCARVE_VEC_SSE2
+#endif
+#include "KernelsVec.hpp"
+#include "KernelsImpl.hpp"
+
+const KernelTable* baselineKernels() {
+#if defined(SEAMCARVE_VEC_SSE2)
+    static const KernelTable table = { "sse2", &grayRowT<VecSse2>, &energyRowT<VecSse2>,
+                                       &costRowT<VecSse2>,
+                                       &costRowWideT<VecSse2>, &transposeT<VecSse2>,
+                                       &grayRow16T<VecSse2>, &energyRow16T<VecSse2>, &transpose16T<VecSse2>,
+                                       &grayRowFT<VecSse2>, &energyRowFT<VecSse2>, &costRowFT<VecSse2> };
+#else
+    static const KernelTable table = { "scalar", &grayRowT<VecScalar>, &energyRowT<VecScalar>,
+                                       &costRowT<VecScalar>,
+                                       &costRowWideT<VecScalar>, &transposeT<VecScalar>,
+                                       &grayRow16T<VecScalar>, &energyRow16T<VecScalar>, &transpose16T<VecScalar>,
+                                       &grayRowFT<VecScalar>, &energyRowFT<VecScalar>, &costRowFT<VecScalar> };
+#endif
+    return &table;
+}
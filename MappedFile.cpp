@@ -0,0 +1,78 @@
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstddef>
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef _WIN32
+
+/**
+ * @brief Create a delete-on-close temporary file and map it.
+ * @throws runtime_error if the file cannot be created or mapped.
+ */
+MappedFile::MappedFile(const std::string& directory, std::size_t size) : size_(size) {
+    char path[MAX_PATH];
+    if (!GetTempFileNameA(directory.c_str(), "sc", 0, path))
+        throw std::runtime_error("Cannot create scratch file in " + directory);
+    file_ = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                        FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        file_ = nullptr;
+        throw std::runtime_error("Cannot create scratch file in " + directory);
+    }
+    const unsigned long long bytes = size ? size : 1;
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READWRITE, DWORD(bytes >> 32),
+                                  DWORD(bytes & 0xffffffffu), nullptr);
+    if (mapping_) data_ = static_cast<unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+    if (!data_) {
+        if (mapping_) CloseHandle(mapping_);
+        CloseHandle(file_);
+        throw std::runtime_error("Cannot map scratch file");
+    }
+}
+
+MappedFile::~MappedFile() {
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+    CloseHandle(file_);
+}
+
+#else
+
+/**
+ * @brief Create a scratch file, size it, map it and unlink it.
+ * @throws runtime_error if the file cannot be created or mapped.
+ */
+MappedFile::MappedFile(const std::string& directory, std::size_t size) : size_(size) {
+    std::string name = (directory.empty() ? std::string(".") : directory) + "/seamcarve-XXXXXX";
+    std::vector<char> path(name.begin(), name.end());
+    path.push_back('\0');
+    int fd = mkstemp(path.data());
+    if (fd < 0) throw std::runtime_error("Cannot create scratch file in " + directory);
+    unlink(path.data());
+    const std::size_t bytes = size ? size : 1;
+    void* p = MAP_FAILED;
+    if (ftruncate(fd, off_t(bytes)) == 0)
+        p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) throw std::runtime_error("Cannot map scratch file of " + std::to_string(bytes) + " bytes");
+    data_ = static_cast<unsigned char*>(p);
+}
+
+MappedFile::~MappedFile() { munmap(data_, size_ ? size_ : 1); }
+
+#endif
+
+unsigned char* MappedFile::data() { return data_; }
+const unsigned char* MappedFile::data() const { return data_; }
+std::size_t MappedFile::size() const { return size_; }
@@ -0,0 +1,41 @@
+#include <string>
+#include <cstddef>
+
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+/**
+ * @class MappedFile
+ * @brief Anonymous scratch file of fixed size mapped read-write into memory.
+ *
+ * The file lives in a given directory and is removed when the mapping is
+ * destroyed (on POSIX systems right after it is mapped). Its pages are
+ * backed by the file instead of swap, so the operating system can evict
+ * them under memory pressure.
+ */
+class MappedFile {
+private:
+    unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+
+public:
+    /**
+     * @brief Create and map a zero-filled scratch file of size bytes in directory.
+     * @throws runtime_error if the file cannot be created or mapped.
+     */
+    MappedFile(const std::string& directory, std::size_t size);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    unsigned char* data();
+    const unsigned char* data() const;
+    std::size_t size() const;
+};
+
+#endif // !MAPPEDFILE_HPP
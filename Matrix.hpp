@@ -0,0 +1,61 @@
+#include <vector>
+#include <cstddef>
+#include <cstring>
+
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+/**
+ * @class Matrix
+ * @brief Dense row-major 2D array in one contiguous allocation.
+ *
+ * resize() keeps the allocation when shrinking, so per-seam scratch matrices
+ * can be reused without touching the allocator.
+ */
+template <typename T>
+class Matrix {
+private:
+    int rows_ = 0, cols_ = 0;
+    std::vector<T> data_;
+
+public:
+    Matrix() = default;
+    Matrix(int rows, int cols) { resize(rows, cols); }
+
+    /** @brief Change dimensions; contents are unspecified afterwards. */
+    void resize(int rows, int cols) {
+        rows_ = rows;
+        cols_ = cols;
+        data_.resize(std::size_t(rows) * cols);
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+    T* row(int r) { return data_.data() + std::size_t(r) * cols_; }
+    const T* row(int r) const { return data_.data() + std::size_t(r) * cols_; }
+
+    T& operator()(int r, int c) { return row(r)[c]; }
+    const T& operator()(int r, int c) const { return row(r)[c]; }
+
+    /**
+     * @brief Remove column seam[r] from every row r, compacting the rows in
+     *        place; the only resize that keeps the contents. T must be trivially copyable.
+     */
+    void removeSeam(const std::vector<int>& seam) {
+        T* data = data_.data();
+        std::size_t dst = 0;
+        for (int r = 0; r < rows_; ++r) {
+            const T* src = data + std::size_t(r) * cols_;
+            const std::size_t cut = seam[r];
+            // destination never overtakes the source, so memmove is safe
+            std::memmove(data + dst, src, cut * sizeof(T));
+            std::memmove(data + dst + cut, src + cut + 1, (cols_ - cut - 1) * sizeof(T));
+            dst += cols_ - 1;
+        }
+        --cols_;
+        data_.resize(dst);
+    }
+};
+
+#endif // !MATRIX_HPP
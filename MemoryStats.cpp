@@ -0,0 +1,88 @@
+#include <atomic>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+#include "MemoryStats.hpp"
+
+namespace {
+
+std::atomic<bool> isHooked{false};
+std::atomic<std::uint64_t> allocations{0}, frees{0}, bytesAllocated{0};
+std::atomic<std::int64_t> liveBytes{0}, peakLiveBytes{0};
+
+} // namespace
+
+void MemoryStats::recordAlloc(std::size_t bytes) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+    std::int64_t live = liveBytes.fetch_add(std::int64_t(bytes), std::memory_order_relaxed) + std::int64_t(bytes);
+    std::int64_t peak = peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+void MemoryStats::recordFree(std::size_t bytes) {
+    frees.fetch_add(1, std::memory_order_relaxed);
+    liveBytes.fetch_sub(std::int64_t(bytes), std::memory_order_relaxed);
+}
+
+void MemoryStats::setHooked() { isHooked = true; }
+bool MemoryStats::hooked() { return isHooked; }
+
+MemoryStats::Snapshot MemoryStats::snapshot() {
+    Snapshot s;
+    s.allocations = allocations.load(std::memory_order_relaxed);
+    s.frees = frees.load(std::memory_order_relaxed);
+    s.bytesAllocated = bytesAllocated.load(std::memory_order_relaxed);
+    s.liveBytes = liveBytes.load(std::memory_order_relaxed);
+    s.peakLiveBytes = peakLiveBytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+void MemoryStats::resetPeak() {
+    peakLiveBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Resident set size from /proc/self/statm on Linux, the working set on Windows.
+ */
+std::int64_t MemoryStats::currentRss() {
+#if defined(__linux__)
+    std::FILE* f = std::fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    long long pages = 0, resident = 0;
+    int n = std::fscanf(f, "%lld %lld", &pages, &resident);
+    std::fclose(f);
+    return n == 2 ? resident * sysconf(_SC_PAGESIZE) : 0;
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+    return std::int64_t(pmc.WorkingSetSize);
+#else
+    return 0;
+#endif
+}
+
+std::int64_t MemoryStats::peakRss() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+    return std::int64_t(pmc.PeakWorkingSetSize);
+#elif defined(__unix__) || defined(__APPLE__)
+    rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+#if defined(__APPLE__)
+    return std::int64_t(ru.ru_maxrss);        // bytes
+#else
+    return std::int64_t(ru.ru_maxrss) * 1024; // kilobytes
+#endif
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,50 @@
+#include <cstddef>
+#include <cstdint>
+
+#ifndef MEMORYSTATS_HPP
+#define MEMORYSTATS_HPP
+
+/**
+ * @class MemoryStats
+ * @brief Process-wide heap allocation counters and resident set size queries.
+ *
+ * The counters are fed by the global operator new/delete replacement in
+ * AllocHook.cpp, which the CLI and benchmark link but the library does not.
+ * Without the hook, hooked() is false and the counters stay at zero.
+ */
+class MemoryStats {
+public:
+    struct Snapshot {
+        std::uint64_t allocations = 0;    // operator new calls
+        std::uint64_t frees = 0;          // operator delete calls
+        std::uint64_t bytesAllocated = 0; // sum of requested sizes
+        std::int64_t liveBytes = 0;       // currently allocated
+        std::int64_t peakLiveBytes = 0;   // high-water mark since the last resetPeak()
+    };
+
+    /** @brief Called by the allocation hook for every allocation. */
+    static void recordAlloc(std::size_t bytes);
+
+    /** @brief Called by the allocation hook for every deallocation. */
+    static void recordFree(std::size_t bytes);
+
+    /** @brief Mark the allocation hook as linked. */
+    static void setHooked();
+
+    /** @brief True if allocations are being counted. */
+    static bool hooked();
+
+    /** @brief Current counter values. */
+    static Snapshot snapshot();
+
+    /** @brief Restart the live-bytes high-water mark at the current live size. */
+    static void resetPeak();
+
+    /** @brief Current resident set size in bytes, or 0 if unknown. */
+    static std::int64_t currentRss();
+
+    /** @brief Peak resident set size of the process in bytes, or 0 if unknown. */
+    static std::int64_t peakRss();
+};
+
+#endif // !MEMORYSTATS_HPP
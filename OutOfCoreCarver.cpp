@@ -0,0 +1,322 @@
+#include <vector>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include "OutOfCoreCarver.hpp"
+#include "Kernels.hpp"
+#include "Gzip.hpp"
+
+namespace {
+
+// Tile edge in pixels for the blocked transpose between scratch files.
+const int kTransposeTile = 256;
+
+/**
+ * @brief Decode count samples of one or two (big endian) bytes.
+ */
+void decode(const unsigned char* src, int* dst, std::size_t count, int sampleBytes) {
+    if (sampleBytes == 1) {
+        for (std::size_t k = 0; k < count; ++k) dst[k] = src[k];
+    } else {
+        for (std::size_t k = 0; k < count; ++k) dst[k] = src[2 * k] << 8 | src[2 * k + 1];
+    }
+}
+
+/** @brief Sample of Bytes (big endian) bytes at p. */
+template <int Bytes>
+inline int sampleAt(const unsigned char* p) {
+    if (Bytes == 1) return p[0];
+    return p[0] << 8 | p[1];
+}
+
+/**
+ * @brief Decode a row straight into gray values, for one sample size and
+ *        channel count (0: `channels`, known at run time).
+ */
+template <int Bytes, int C>
+void grayDecode(const unsigned char* src, int* gray, int width, int channels) {
+    const int n = C ? C : channels;
+    for (int j = 0; j < width; ++j) {
+        int sum = 0;
+        for (int c = 0; c < n; ++c) sum += sampleAt<Bytes>(src + (std::size_t(j) * n + c) * Bytes);
+        gray[j] = sum / n;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Copy the image into a scratch file, decoding ASCII samples and
+ *        inflating gzip input on the way.
+ * @throws runtime_error on I/O or format error.
+ */
+OutOfCoreCarver::OutOfCoreCarver(const std::string& filename, const std::string& scratchDir)
+    : scratchDir_(scratchDir) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open input file");
+    std::unique_ptr<InflateBuf> inflate;
+    std::unique_ptr<std::istream> gz;
+    if (InflateBuf::detect(file)) {
+        inflate = std::make_unique<InflateBuf>(file);
+        gz = std::make_unique<std::istream>(inflate.get());
+        gz->exceptions(std::ios::badbit);
+    }
+    std::istream& in = gz ? *gz : file;
+    header_ = PnmHeader::read(in);
+    if (header_.isFloat()) throw std::runtime_error("Float images cannot be carved out of core");
+    outHeader_ = header_;
+    width_ = header_.width;
+    height_ = header_.height;
+    channels_ = header_.channels();
+    sampleBytes_ = header_.sampleBytes();
+    pixelBytes_ = std::size_t(channels_) * sampleBytes_;
+    pixels_ = std::make_unique<MappedFile>(scratchDir_, std::size_t(width_) * height_ * pixelBytes_);
+    const bool wide = sampleBytes_ == 2;
+    switch (channels_) {
+    case 1:  grayDecode_ = wide ? &grayDecode<2, 1> : &grayDecode<1, 1>; break;
+    case 3:  grayDecode_ = wide ? &grayDecode<2, 3> : &grayDecode<1, 3>; break;
+    case 4:  grayDecode_ = wide ? &grayDecode<2, 4> : &grayDecode<1, 4>; break;
+    default: grayDecode_ = wide ? &grayDecode<2, 0> : &grayDecode<1, 0>; break;
+    }
+
+    const std::size_t rowSamples = std::size_t(width_) * channels_;
+    for (int i = 0; i < height_; ++i) {
+        unsigned char* row = pixels_->data() + i * stride();
+        if (header_.binary()) {
+            if (!in.read(reinterpret_cast<char*>(row), rowSamples * sampleBytes_))
+                throw std::runtime_error("Insufficient pixel data");
+            continue;
+        }
+        for (std::size_t k = 0; k < rowSamples; ++k) {
+            int v;
+            if (!(in >> v))
+                throw std::runtime_error(channels_ == 1 ? "Insufficient gray pixel data"
+                                                        : "Insufficient color pixel data");
+            if (v < 0 || v > header_.maxValue) throw std::runtime_error("Sample above max value");
+            if (sampleBytes_ == 1) {
+                row[k] = (unsigned char)v;
+            } else {
+                row[2 * k] = (unsigned char)(v >> 8);
+                row[2 * k + 1] = (unsigned char)(v & 0xff);
+            }
+        }
+    }
+}
+
+void OutOfCoreCarver::setProfiler(Profiler* profiler) { profiler_ = profiler; }
+
+void OutOfCoreCarver::setCostType(SeamCarver::CostType type) { costType_ = type; }
+
+void OutOfCoreCarver::setEnergyChannels(const std::vector<int>& channels) {
+    for (int c : channels)
+        if (c < 0 || c >= channels_) throw std::runtime_error("Energy channel out of range");
+    energyChannels_ = channels;
+}
+
+int OutOfCoreCarver::getWidth() const { return isTransposed_ ? height_ : width_; }
+
+int OutOfCoreCarver::getHeight() const { return isTransposed_ ? width_ : height_; }
+
+int OutOfCoreCarver::getChannels() const { return channels_; }
+
+MappedFile& OutOfCoreCarver::store() { return isTransposed_ ? *transposed_ : *pixels_; }
+
+/**
+ * @brief Row stride of the current store: the original row length, so seam
+ *        removal never moves data between rows.
+ */
+std::size_t OutOfCoreCarver::stride() const {
+    return (isTransposed_ ? header_.height : header_.width) * pixelBytes_;
+}
+
+/**
+ * @brief Decode row r of the current orientation into gray values.
+ */
+void OutOfCoreCarver::grayRow(int r, int* gray) {
+    const unsigned char* src = store().data() + r * stride();
+    if (energyChannels_.empty()) {
+        grayDecode_(src, gray, width_, channels_);
+        return;
+    }
+    const int count = int(energyChannels_.size());
+    for (int j = 0; j < width_; ++j) {
+        const unsigned char* p = src + j * pixelBytes_;
+        int sum = 0;
+        for (int c : energyChannels_)
+            sum += sampleBytes_ == 1 ? p[c] : p[2 * c] << 8 | p[2 * c + 1];
+        gray[j] = sum / count;
+    }
+}
+
+/**
+ * @brief Switch orientation via a blocked copy into the other store.
+ */
+void OutOfCoreCarver::transpose() {
+    Profiler::Scope scope(profiler_, Profiler::Transpose, (long long)width_ * height_);
+    if (!transposed_)
+        transposed_ = std::make_unique<MappedFile>(scratchDir_, pixels_->size());
+    const unsigned char* src = store().data();
+    const std::size_t srcStride = stride();
+    isTransposed_ = !isTransposed_;
+    unsigned char* dst = store().data();
+    const std::size_t dstStride = stride();
+    for (int ib = 0; ib < height_; ib += kTransposeTile) {
+        const int iEnd = std::min(ib + kTransposeTile, height_);
+        for (int jb = 0; jb < width_; jb += kTransposeTile) {
+            const int jEnd = std::min(jb + kTransposeTile, width_);
+            for (int i = ib; i < iEnd; ++i)
+                for (int j = jb; j < jEnd; ++j)
+                    std::memcpy(dst + j * dstStride + i * pixelBytes_,
+                                src + i * srcStride + j * pixelBytes_, pixelBytes_);
+        }
+    }
+    std::swap(width_, height_);
+}
+
+/**
+ * @brief Energy and cumulative cost row by row, recording the step into each pixel.
+ */
+template <typename Cost>
+int OutOfCoreCarver::forwardPass(std::vector<Cost> (&cost)[2]) {
+    const int w = width_, h = height_;
+    const KernelTable& k = Kernels::get();
+    cost[0].resize(w);
+    cost[1].resize(w);
+    unsigned char* steps = steps_->data();
+    Cost* prev = cost[0].data();
+    Cost* cur = cost[1].data();
+    Profiler::Scope scope(profiler_, Profiler::Forward, (long long)w * h);
+    int* g[3] = { gray_[0].data(), gray_[1].data(), gray_[2].data() }; // rows i-1, i, i+1
+    grayRow(0, g[1]);
+    for (int i = 0; i < h; ++i) {
+        if (i < h - 1) grayRow(i + 1, g[2]);
+        k.energyRow(i > 0 ? g[0] : g[1], g[1], i < h - 1 ? g[2] : g[1], energy_.data(), w);
+        if (i == 0) {
+            std::copy(energy_.begin(), energy_.end(), prev);
+        } else {
+            if constexpr (sizeof(Cost) == sizeof(int))
+                k.costRow(prev, energy_.data(), cur, 0, w, w);
+            else
+                k.costRowWide(prev, energy_.data(), cur, 0, w, w);
+            // step from row i-1 into (i, j), with the leftmost minimum on ties
+            // as in SeamCarver::backtrackSeam
+            unsigned char* step = steps + std::size_t(i) * w;
+            step[0] = w > 1 && prev[1] < prev[0];
+            for (int j = 1; j < w - 1; ++j) {
+                // branchless so the loop vectorizes
+                const Cost a = prev[j - 1], b = prev[j], c = prev[j + 1];
+                const Cost m = b < a ? b : a;
+                step[j] = (unsigned char)(c < m ? 2 : b < a ? 1 : 0);
+            }
+            if (w > 1) step[w - 1] = prev[w - 1] < prev[w - 2];
+            std::swap(prev, cur);
+        }
+        std::swap(g[0], g[1]);
+        std::swap(g[1], g[2]);
+    }
+    return int(std::min_element(prev, prev + w) - prev);
+}
+
+/**
+ * @brief Find and remove one vertical seam in a single streaming pass.
+ */
+void OutOfCoreCarver::carveSeam() {
+    const int w = width_, h = height_;
+    if (!steps_) steps_ = std::make_unique<MappedFile>(scratchDir_, std::size_t(width_) * height_);
+    for (auto& g : gray_) g.resize(w);
+    energy_.resize(w);
+    seam_.resize(h);
+    // binary samples are not checked against the max value, so bound them by their size
+    const int maxSample = header_.binary() ? (1 << 8 * sampleBytes_) - 1 : header_.maxValue;
+    const bool wide = SeamCarver::costTypeFor(costType_, h, maxSample) == SeamCarver::Cost64;
+    seam_[h - 1] = wide ? forwardPass(wideCost_) : forwardPass(cost_);
+    {
+        Profiler::Scope scope(profiler_, Profiler::Backtrack, (long long)w * h);
+        const unsigned char* steps = steps_->data();
+        for (int i = h - 1; i > 0; --i) {
+            const int j = seam_[i];
+            seam_[i - 1] = std::max(0, j - 1) + steps[std::size_t(i) * w + j];
+        }
+    }
+    Profiler::Scope scope(profiler_, Profiler::Remove, (long long)w * h);
+    unsigned char* data = store().data();
+    for (int i = 0; i < h; ++i) {
+        unsigned char* row = data + i * stride();
+        const std::size_t cut = seam_[i] * pixelBytes_;
+        std::memmove(row + cut, row + cut + pixelBytes_, (w - 1) * pixelBytes_ - cut);
+    }
+    --width_;
+    if (profiler_) profiler_->addSeam();
+}
+
+/** @brief Remove N vertical seams. */
+void OutOfCoreCarver::removeVerticalSeams(int count) {
+    if (count > 0 && isTransposed_) transpose();
+    for (int s = 0; s < count; ++s) carveSeam();
+}
+
+/** @brief Remove N horizontal seams, all on one transposed copy. */
+void OutOfCoreCarver::removeHorizontalSeams(int count) {
+    if (count > 0 && !isTransposed_) transpose();
+    for (int s = 0; s < count; ++s) carveSeam();
+}
+
+/**
+ * @brief Convert the output header.
+ * @throws runtime_error for QOI.
+ */
+void OutOfCoreCarver::setFormat(Image::Format format) {
+    if (format == Image::QoiFormat) throw std::runtime_error("QOI output cannot be written out of core");
+    outHeader_ = header_.converted(format != Image::AsciiFormat, format == Image::PamFormat);
+}
+
+/**
+ * @brief Write the image in the output format, gzip compressed for a ".gz" name.
+ * @throws runtime_error on I/O error.
+ */
+void OutOfCoreCarver::write(const std::string& filename) {
+    if (isTransposed_) transpose();
+    Profiler::Scope scope(profiler_, Profiler::Write, (long long)width_ * height_);
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open output file");
+    std::unique_ptr<DeflateBuf> deflate;
+    std::unique_ptr<std::ostream> gz;
+    if (isGzipName(filename)) {
+        deflate = std::make_unique<DeflateBuf>(file);
+        gz = std::make_unique<std::ostream>(deflate.get());
+        gz->exceptions(std::ios::badbit);
+    }
+    std::ostream& out = gz ? *gz : file;
+    PnmHeader header = outHeader_;
+    header.width = width_;
+    header.height = height_;
+    header.write(out);
+
+    const std::size_t rowSamples = std::size_t(width_) * channels_;
+    std::string text;
+    for (int i = 0; i < height_; ++i) {
+        const unsigned char* row = pixels_->data() + i * stride();
+        if (header.binary()) {
+            out.write(reinterpret_cast<const char*>(row), rowSamples * sampleBytes_);
+            continue;
+        }
+        // same layout as Image::write: every sample followed by a space
+        samples_.resize(rowSamples);
+        decode(row, samples_.data(), rowSamples, sampleBytes_);
+        text.clear();
+        char digits[16];
+        for (std::size_t s = 0; s < rowSamples; ++s) {
+            char* end = std::to_chars(digits, digits + sizeof(digits), samples_[s]).ptr;
+            text.append(digits, end);
+            text.push_back(' ');
+        }
+        text.push_back('\n');
+        out.write(text.data(), text.size());
+    }
+    if (deflate) deflate->finish();
+    if (!out) throw std::runtime_error("Cannot write output file");
+}
@@ -0,0 +1,127 @@
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+#include "Pnm.hpp"
+#include "MappedFile.hpp"
+#include "Profiler.hpp"
+#include "SeamCarver.hpp"
+
+#ifndef OUTOFCORECARVER_HPP
+#define OUTOFCORECARVER_HPP
+
+/**
+ * @class OutOfCoreCarver
+ * @brief Seam carving for images larger than memory.
+ *
+ * Pixels stay in their file encoding (one or two bytes per sample) in a
+ * memory-mapped scratch file with a fixed row stride, so removing a seam
+ * only moves bytes within each row. Each seam is found in one streaming
+ * pass that computes energy and cumulative cost row by row, keeping just
+ * three gray rows and two cost rows in memory; the step taken into each
+ * pixel goes to a second scratch file of one byte per pixel, which the
+ * backtrack reads upwards. Horizontal seams are carved on a transposed copy
+ * made once, not per seam. Memory use is O(width + height); the scratch
+ * files need about three times the decoded image size in bytes.
+ *
+ * Seams match those of SeamCarver, so the result is identical.
+ */
+class OutOfCoreCarver {
+private:
+    PnmHeader header_, outHeader_;  // input, and output format (see setFormat)
+    std::string scratchDir_;
+    int width_, height_;          // current size, in the current orientation
+    int channels_, sampleBytes_;
+    std::size_t pixelBytes_;
+    std::unique_ptr<MappedFile> pixels_, transposed_, steps_;
+    bool isTransposed_ = false;
+    Profiler* profiler_ = nullptr;
+    SeamCarver::CostType costType_ = SeamCarver::AutoCost;
+
+    // decodes a row of the input's sample size and channel count to gray
+    void (*grayDecode_)(const unsigned char* src, int* gray, int width, int channels) = nullptr;
+    std::vector<int> energyChannels_;
+
+    // per-seam scratch, O(width + height)
+    std::vector<int> samples_, gray_[3], energy_, cost_[2], seam_;
+    std::vector<long long> wideCost_[2];
+
+    /** @brief Store holding the current orientation. */
+    MappedFile& store();
+
+    /** @brief Bytes between rows of the current orientation. */
+    std::size_t stride() const;
+
+    /** @brief Decode row r of the current orientation into gray values. */
+    void grayRow(int r, int* gray);
+
+    /** @brief Switch orientation via a blocked copy into the other store. */
+    void transpose();
+
+    /**
+     * @brief Streaming energy and cost pass over the current orientation,
+     *        filling steps_ and costs in cost.
+     * @return Column of the cheapest seam in the bottom row.
+     */
+    template <typename Cost>
+    int forwardPass(std::vector<Cost> (&cost)[2]);
+
+    /** @brief Find and remove one vertical seam of the current orientation. */
+    void carveSeam();
+
+public:
+    /**
+     * @brief Copy a P2, P3, P5, P6 or P7 image, possibly gzip compressed, into
+     *        a scratch file in scratchDir.
+     * @throws runtime_error on I/O or format error, or a PFM image.
+     */
+    OutOfCoreCarver(const std::string& filename, const std::string& scratchDir);
+
+    /**
+     * @brief Record per-phase timings into profiler (nullptr disables). Energy
+     *        is computed inside the Forward phase. Not owned.
+     */
+    void setProfiler(Profiler* profiler);
+
+    /** @brief See SeamCarver::setCostType. */
+    void setCostType(SeamCarver::CostType type);
+
+    /**
+     * @brief See SeamCarver::setEnergyChannels.
+     * @throws runtime_error on a channel the image does not have.
+     */
+    void setEnergyChannels(const std::vector<int>& channels);
+
+    /**
+     * @brief Write ASCII, binary or PAM output instead of the input format;
+     *        the scratch file already holds the binary samples, so any of
+     *        them is a header change.
+     * @throws runtime_error for QOI, which needs the image in memory.
+     */
+    void setFormat(Image::Format format);
+
+    /** @brief Remove N vertical seams. */
+    void removeVerticalSeams(int count);
+
+    /** @brief Remove N horizontal seams. */
+    void removeHorizontalSeams(int count);
+
+    /** @brief Current width. */
+    int getWidth() const;
+
+    /** @brief Current height. */
+    int getHeight() const;
+
+    /** @brief Samples per pixel. */
+    int getChannels() const;
+
+    /**
+     * @brief Write the image in its input format (or the one setFormat()
+     *        chose), comments included; gzip
+     *        compressed if filename ends in ".gz".
+     * @throws runtime_error on I/O error.
+     */
+    void write(const std::string& filename);
+};
+
+#endif // !OUTOFCORECARVER_HPP
@@ -0,0 +1,170 @@
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <fstream>
+#include <algorithm>
+#include <exception>
+#include <utility>
+#include <stdexcept>
+#include <functional>
+#include "ParallelVideoCarver.hpp"
+#include "VideoCarver.hpp"
+#include "SceneCut.hpp"
+#include "FrameSequence.hpp"
+#include "Y4M.hpp"
+
+namespace {
+
+/**
+ * @brief Call fn(i) for i in [0, count) on all pool threads, handing out
+ *        items one at a time. The first exception is rethrown afterwards.
+ */
+void forEach(ThreadPool& pool, long long count, const std::function<void(long long)>& fn) {
+    std::atomic<long long> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    pool.run(pool.size(), [&](int, int) {
+        for (long long i; (i = next.fetch_add(1)) < count;) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+                next = count; // stop handing out work
+            }
+        }
+    });
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace
+
+ParallelVideoCarver::ParallelVideoCarver(int vertical, int horizontal, ThreadPool& pool)
+    : vertical_(vertical), horizontal_(horizontal), pool_(pool) {}
+
+void ParallelVideoCarver::setBand(int radius) { band_ = radius; }
+
+void ParallelVideoCarver::setKeyframeInterval(int frames) { keyframeInterval_ = frames; }
+
+void ParallelVideoCarver::setSceneCutThreshold(double threshold) { cutThreshold_ = threshold; }
+
+void ParallelVideoCarver::setMaxSegment(long long frames) { maxSegment_ = frames; }
+
+const std::vector<ParallelVideoCarver::Segment>& ParallelVideoCarver::segments() const {
+    return segments_;
+}
+
+/**
+ * @brief Split frames at scene cuts and at the segment length limit.
+ */
+void ParallelVideoCarver::findSegments(long long frames,
+                                       const std::function<Image(long long)>& luma) {
+    std::vector<char> cut(frames, 0);
+    if (cutThreshold_ > 0) {
+        std::vector<SceneCutDetector::Histogram> hist(frames);
+        forEach(pool_, frames, [&](long long i) { hist[i] = SceneCutDetector::histogram(luma(i)); });
+        for (long long i = 1; i < frames; ++i)
+            cut[i] = SceneCutDetector::difference(hist[i - 1], hist[i]) > cutThreshold_;
+    }
+    segments_.clear();
+    for (long long i = 0; i < frames; ++i) {
+        if (i == 0 || cut[i] || (maxSegment_ > 0 && segments_.back().count >= maxSegment_))
+            segments_.push_back({ i, 0 });
+        ++segments_.back().count;
+    }
+}
+
+/**
+ * @brief Carve every segment on the pool, longest first.
+ */
+void ParallelVideoCarver::carveSegments(const std::function<void(const Segment&)>& carve) {
+    std::vector<Segment> order = segments_;
+    std::stable_sort(order.begin(), order.end(),
+                     [](const Segment& a, const Segment& b) { return a.count > b.count; });
+    forEach(pool_, (long long)order.size(), [&](long long s) { carve(order[s]); });
+}
+
+/**
+ * @brief Carve numbered P2/P3 frames scene by scene.
+ * @return Number of frames carved.
+ */
+long long ParallelVideoCarver::carveFrames(const std::string& inPattern,
+                                           const std::string& outPattern, long long first) {
+    const FramePattern in(inPattern), out(outPattern);
+    long long frames = 0;
+    while (std::ifstream(in.name(first + frames))) ++frames;
+    if (frames == 0) throw std::runtime_error("No frames in input");
+
+    findSegments(frames, [&](long long i) { return Image(in.name(first + i)); });
+    carveSegments([&](const Segment& seg) {
+        VideoCarver carver(vertical_, horizontal_);
+        carver.setBand(band_);
+        carver.setKeyframeInterval(keyframeInterval_);
+        carver.setSceneCutThreshold(0);
+        for (long long i = seg.first; i < seg.first + seg.count; ++i)
+            carver.carve(Image(in.name(first + i))).write(out.name(first + i));
+    });
+    return frames;
+}
+
+/**
+ * @brief Carve a Y4M file scene by scene; every segment writes its frames
+ *        straight to their offsets in the output file.
+ * @return Number of frames carved.
+ */
+long long ParallelVideoCarver::carveY4M(const std::string& inFile, const std::string& outFile) {
+    std::ifstream file(inFile, std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open input file");
+    Y4MReader index(file);
+    const Y4MHeader header = index.header();
+    std::vector<long long> offsets;
+    for (long long pos = file.tellg(); index.skip(); pos = file.tellg()) offsets.push_back(pos);
+    const long long frames = (long long)offsets.size();
+    if (frames == 0) throw std::runtime_error("No frames in input");
+
+    Y4MHeader outHeader = header;
+    outHeader.width -= vertical_;
+    outHeader.height -= horizontal_;
+    if (outHeader.width <= 0 || outHeader.height <= 0)
+        throw std::runtime_error("Requested seams exceed frame dimensions");
+    {
+        std::ofstream out(outFile, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Cannot open output file");
+        Y4MWriter writer(out, outHeader);
+    }
+    // output frames all have the same size and a plain FRAME line
+    const long long outStart = (long long)outHeader.str().size() + 1;
+    const long long outFrame = 6 + outHeader.frameBytes();
+
+    auto open = [&](long long i, std::ifstream& in) {
+        in.open(inFile, std::ios::binary);
+        if (!in || !in.seekg(offsets[i])) throw std::runtime_error("Cannot open input file");
+    };
+    findSegments(frames, [&](long long i) {
+        std::ifstream in;
+        open(i, in);
+        std::vector<Image> planes;
+        if (!Y4MReader(in, header).next(planes)) throw std::runtime_error("Truncated Y4M frame");
+        return std::move(planes[0]);
+    });
+    carveSegments([&](const Segment& seg) {
+        std::ifstream in;
+        open(seg.first, in);
+        std::fstream out(outFile, std::ios::binary | std::ios::in | std::ios::out);
+        if (!out || !out.seekp(outStart + seg.first * outFrame))
+            throw std::runtime_error("Cannot open output file");
+        Y4MReader reader(in, header);
+        Y4MWriter writer(out, outHeader, false);
+        VideoCarver carver(vertical_, horizontal_);
+        carver.setBand(band_);
+        carver.setKeyframeInterval(keyframeInterval_);
+        carver.setSceneCutThreshold(0);
+        std::vector<Image> planes;
+        for (long long i = 0; i < seg.count; ++i) {
+            if (!reader.next(planes)) throw std::runtime_error("Truncated Y4M frame");
+            writer.write(carveY4MFrame(carver, header, std::move(planes)));
+        }
+    });
+    return frames;
+}
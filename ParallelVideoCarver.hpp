@@ -0,0 +1,92 @@
+#include <vector>
+#include <string>
+#include <functional>
+#include "Image.hpp"
+#include "ThreadPool.hpp"
+
+#ifndef PARALLELVIDEOCARVER_HPP
+#define PARALLELVIDEOCARVER_HPP
+
+/**
+ * @class ParallelVideoCarver
+ * @brief Carves a whole video file by scene, several scenes at a time.
+ *
+ * A first pass computes the luminance histogram of every frame and splits
+ * the sequence at scene cuts. Each segment is then carved front to back by
+ * one pool thread with its own VideoCarver, so seams stay coherent within
+ * a scene while different scenes run concurrently. Needs random access, so
+ * it works on numbered frame files and on Y4M files, not on pipes.
+ */
+class ParallelVideoCarver {
+public:
+    /**
+     * @struct Segment
+     * @brief Frames [first, first + count), relative to the first input frame.
+     */
+    struct Segment {
+        long long first, count;
+    };
+
+private:
+    int vertical_, horizontal_;
+    ThreadPool& pool_;
+    int band_ = 8;
+    int keyframeInterval_ = 0;
+    double cutThreshold_ = 0.35;
+    long long maxSegment_ = 0;
+    std::vector<Segment> segments_;
+
+    /**
+     * @brief Split frames [0, frames) at scene cuts, then into pieces of at
+     *        most maxSegment_ frames; luma(i) loads frame i.
+     */
+    void findSegments(long long frames, const std::function<Image(long long)>& luma);
+
+    /**
+     * @brief Run carve(segment) for every segment on the pool, longest first.
+     *        The first exception thrown by any segment is rethrown.
+     */
+    void carveSegments(const std::function<void(const Segment&)>& carve);
+
+public:
+    /**
+     * @param pool Threads that carve segments; a segment runs single-threaded. Not owned.
+     */
+    ParallelVideoCarver(int vertical, int horizontal, ThreadPool& pool);
+
+    /** @brief See VideoCarver::setBand. */
+    void setBand(int radius);
+
+    /** @brief See VideoCarver::setKeyframeInterval; counted within each segment. */
+    void setKeyframeInterval(int frames);
+
+    /** @brief See SceneCutDetector; 0 splits only by setMaxSegment. */
+    void setSceneCutThreshold(double threshold);
+
+    /**
+     * @brief Split scenes longer than frames so they spread over more threads,
+     *        at the cost of a full search at each split (0, the default: no limit).
+     */
+    void setMaxSegment(long long frames);
+
+    /**
+     * @brief Carve numbered P2/P3 frames from inPattern, starting at number
+     *        first, to outPattern (see FramePattern).
+     * @return Number of frames carved.
+     * @throws runtime_error on I/O or format error, or if there are no frames.
+     */
+    long long carveFrames(const std::string& inPattern, const std::string& outPattern,
+                          long long first);
+
+    /**
+     * @brief Carve a Y4M file into another (see carveY4MFrame).
+     * @return Number of frames carved.
+     * @throws runtime_error on I/O or format error, or if there are no frames.
+     */
+    long long carveY4M(const std::string& inFile, const std::string& outFile);
+
+    /** @brief Segments of the last carve. */
+    const std::vector<Segment>& segments() const;
+};
+
+#endif // !PARALLELVIDEOCARVER_HPP
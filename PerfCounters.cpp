@@ -0,0 +1,97 @@
+#include <array>
+#include <cstdint>
+#include <cstring>
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "PerfCounters.hpp"
+
+#if defined(__linux__)
+
+namespace {
+
+int openCounter(std::uint32_t type, std::uint64_t config, int group) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group < 0 ? 1 : 0; // the leader starts the whole group
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+    return int(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+}
+
+std::uint64_t cacheConfig(std::uint64_t cache, std::uint64_t op, std::uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+} // namespace
+
+PerfCounters::PerfCounters() {
+    fds_.fill(-1);
+    const struct { std::uint32_t type; std::uint64_t config; } events[EventCount] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                          PERF_COUNT_HW_CACHE_RESULT_MISS) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+    leader_ = openCounter(events[Cycles].type, events[Cycles].config, -1);
+    if (leader_ < 0) return;
+    fds_[Cycles] = leader_;
+    valid_[Cycles] = true;
+    for (int e = Cycles + 1; e < EventCount; ++e) {
+        fds_[e] = openCounter(events[e].type, events[e].config, leader_);
+        valid_[e] = fds_[e] >= 0;
+    }
+    for (int e = 0; e < EventCount; ++e)
+        if (valid_[e]) ioctl(fds_[e], PERF_EVENT_IOC_ID, &ids_[e]);
+    ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds_)
+        if (fd >= 0) close(fd);
+}
+
+/**
+ * @brief Read the whole group with one syscall and map values back by event id.
+ */
+PerfCounters::Values PerfCounters::read() const {
+    Values v{};
+    if (leader_ < 0) return v;
+    // layout: nr, then {value, id} per member
+    std::uint64_t buf[1 + 2 * EventCount] = {};
+    if (::read(leader_, buf, sizeof(buf)) <= 0) return v;
+    for (std::uint64_t k = 0; k < buf[0] && k < EventCount; ++k) {
+        for (int e = 0; e < EventCount; ++e) {
+            if (valid_[e] && ids_[e] == buf[2 + 2 * k]) v[e] = buf[1 + 2 * k];
+        }
+    }
+    return v;
+}
+
+#else
+
+PerfCounters::PerfCounters() { fds_.fill(-1); }
+PerfCounters::~PerfCounters() {}
+PerfCounters::Values PerfCounters::read() const { return Values{}; }
+
+#endif
+
+bool PerfCounters::available() const { return leader_ >= 0; }
+bool PerfCounters::valid(Event e) const { return valid_[e]; }
+
+const char* PerfCounters::eventName(Event e) {
+    static const char* const names[EventCount] = {
+        "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+    };
+    return names[e];
+}
@@ -0,0 +1,49 @@
+#include <array>
+#include <cstdint>
+
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+/**
+ * @class PerfCounters
+ * @brief Hardware performance counters of the calling thread via Linux perf_event_open.
+ *
+ * Opening fails quietly (e.g. in containers or with a restrictive
+ * perf_event_paranoid); available() then reports false and every read
+ * returns zeros, so callers never need a separate code path. On other
+ * platforms the counters are never available.
+ */
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, L1DMisses, LLCMisses, BranchMisses, EventCount };
+
+    using Values = std::array<std::uint64_t, EventCount>;
+
+private:
+    int leader_ = -1;
+    std::array<int, EventCount> fds_;
+    std::array<bool, EventCount> valid_{};
+    std::array<std::uint64_t, EventCount> ids_{};
+
+public:
+    /** @brief Open and start the counters for the calling thread (user space only). */
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /** @brief True if at least the cycle counter could be opened. */
+    bool available() const;
+
+    /** @brief True if a specific event is being counted. */
+    bool valid(Event e) const;
+
+    /** @brief Current counter values; unavailable events read as zero. */
+    Values read() const;
+
+    /** @brief Lower-case name of an event. */
+    static const char* eventName(Event e);
+};
+
+#endif // !PERFCOUNTERS_HPP
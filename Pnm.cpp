@@ -0,0 +1,148 @@
+#include <string>
+#include <sstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include "Pnm.hpp"
+
+namespace {
+
+/**
+ * @brief Parse the PAM header lines after the magic number, up to ENDHDR.
+ */
+void readPam(std::istream& in, PnmHeader& h) {
+    std::string line;
+    for (;;) {
+        if (!std::getline(in, line)) throw std::runtime_error("Truncated PAM header");
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        if (line[0] == '#') {
+            h.comments.push_back(line);
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string key, value;
+        fields >> key;
+        if (key == "ENDHDR") return;
+        if (key == "TUPLTYPE") {
+            // several TUPLTYPE lines are joined with spaces
+            std::getline(fields >> std::ws, value);
+            h.tupleType += (h.tupleType.empty() ? "" : " ") + value;
+            continue;
+        }
+        int* field = key == "WIDTH" ? &h.width : key == "HEIGHT" ? &h.height
+                   : key == "DEPTH" ? &h.depth : key == "MAXVAL" ? &h.maxValue : nullptr;
+        if (!field || !(fields >> *field)) throw std::runtime_error("Invalid PAM header line: " + line);
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Parse a header, capturing the comment lines after the magic number.
+ * @throws runtime_error on unknown magic or invalid dimensions.
+ */
+PnmHeader PnmHeader::read(std::istream& in) {
+    PnmHeader h;
+    in >> h.magic;
+    if (h.magic != "P2" && h.magic != "P3" && h.magic != "P5" && h.magic != "P6" && h.magic != "P7"
+        && h.magic != "PF" && h.magic != "Pf")
+        throw std::runtime_error("Invalid magic (expected P2, P3, P5, P6, P7, PF or Pf)");
+
+    std::string line;
+    std::getline(in, line);  // finish magic line
+    if (h.magic == "P7") {
+        readPam(in, h);
+        if (h.width<=0 || h.height<=0 || h.depth<=0 || h.maxValue<=0 || h.maxValue > 65535)
+            throw std::runtime_error("Invalid dimensions, depth or max value");
+        return h;
+    }
+    while (in.peek() == '#') {
+        std::getline(in, line);
+        h.comments.push_back(line);
+    }
+    if (h.isFloat()) {
+        in >> h.width >> h.height >> h.scale;
+        if (!in || h.width<=0 || h.height<=0 || h.scale == 0)
+            throw std::runtime_error("Invalid dimensions or scale");
+        h.maxValue = 1;
+        in.get();
+        return h;
+    }
+    in >> h.width >> h.height >> h.maxValue;
+    if (!in || h.width<=0 || h.height<=0 || h.maxValue<=0 || h.maxValue > 65535)
+        throw std::runtime_error("Invalid dimensions or max value");
+    if (h.binary()) in.get();
+    return h;
+}
+
+/** @brief Write magic, comments, dimensions and max value. */
+void PnmHeader::write(std::ostream& out) const {
+    out << magic << '\n';
+    for (const auto& c : comments) out << c << '\n';
+    if (magic == "P7") {
+        out << "WIDTH " << width << "\nHEIGHT " << height << "\nDEPTH " << depth
+            << "\nMAXVAL " << maxValue << '\n';
+        if (!tupleType.empty()) out << "TUPLTYPE " << tupleType << '\n';
+        out << "ENDHDR\n";
+        return;
+    }
+    if (isFloat()) {
+        out << width << ' ' << height << '\n' << scale << '\n';
+        return;
+    }
+    out << width << ' ' << height << '\n'
+        << maxValue << '\n';
+}
+
+int PnmHeader::channels() const {
+    if (magic == "P7") return depth;
+    return magic == "P3" || magic == "P6" || magic == "PF" ? 3 : 1;
+}
+
+bool PnmHeader::binary() const {
+    return magic == "P5" || magic == "P6" || magic == "P7" || isFloat();
+}
+
+bool PnmHeader::isFloat() const { return magic == "PF" || magic == "Pf"; }
+
+int PnmHeader::sampleBytes() const {
+    if (isFloat()) return 4;
+    return maxValue > 255 ? 2 : 1;
+}
+
+bool PnmHeader::hasAlpha() const {
+    const std::string suffix = "_ALPHA";
+    return magic == "P7" && tupleType.size() >= suffix.size()
+        && tupleType.compare(tupleType.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+PnmHeader PnmHeader::forChannels(int channels, bool binary, bool pam) {
+    PnmHeader h;
+    if (!pam && (channels == 1 || channels == 3)) {
+        h.magic = channels == 1 ? (binary ? "P5" : "P2") : (binary ? "P6" : "P3");
+        return h;
+    }
+    h.magic = "P7";
+    h.depth = channels;
+    if      (channels == 1) h.tupleType = "GRAYSCALE";
+    else if (channels == 2) h.tupleType = "GRAYSCALE_ALPHA";
+    else if (channels == 3) h.tupleType = "RGB";
+    else if (channels == 4) h.tupleType = "RGB_ALPHA";
+    return h;
+}
+
+/**
+ * @brief Same image in another netpbm family.
+ * @throws runtime_error for PFM.
+ */
+PnmHeader PnmHeader::converted(bool binary, bool pam) const {
+    if (isFloat()) throw std::runtime_error("Float images can only be written as PFM");
+    PnmHeader h = forChannels(channels(), binary, pam);
+    if (h.magic == "P7" && magic == "P7" && !tupleType.empty()) h.tupleType = tupleType;
+    h.comments = comments;
+    h.width = width;
+    h.height = height;
+    h.maxValue = maxValue;
+    return h;
+}
@@ -0,0 +1,70 @@
+#include <vector>
+#include <string>
+#include <iosfwd>
+
+#ifndef PNM_HPP
+#define PNM_HPP
+
+/**
+ * @struct PnmHeader
+ * @brief Header of a netpbm file: PGM/PPM in ASCII (P2, P3) or binary (P5, P6)
+ *        form, PAM (P7) with any number of channels, or a Portable Float Map
+ *        (PF color, Pf gray) of 32-bit floats.
+ *
+ * Comment lines directly after the magic number, and for PAM anywhere in
+ * the header, are kept so they can be written back after the magic number.
+ */
+struct PnmHeader {
+    std::string magic;
+    std::vector<std::string> comments;
+    int width = 0, height = 0, maxValue = 0;
+    int depth = 0;          // PAM channels per pixel
+    std::string tupleType;  // PAM tuple type, e.g. RGB_ALPHA; may be empty
+    double scale = 0;       // PFM scale; negative for little endian samples
+
+    /**
+     * @brief Parse a header. For binary formats the single whitespace after
+     *        the max value (or the ENDHDR line) is consumed too, so in is left
+     *        at the first sample.
+     * @throws runtime_error on unknown magic or invalid dimensions.
+     */
+    static PnmHeader read(std::istream& in);
+
+    /** @brief Write magic, comments, dimensions and max value, one per line. */
+    void write(std::ostream& out) const;
+
+    /** @brief 1 for P2/P5/Pf, 3 for P3/P6/PF, depth for P7. */
+    int channels() const;
+
+    /** @brief True for P5/P6/P7 and PFM. */
+    bool binary() const;
+
+    /** @brief True for PFM: float samples, rows stored bottom to top. */
+    bool isFloat() const;
+
+    /**
+     * @brief Bytes per sample in binary form: 1, or 2 (big endian) above 255;
+     *        4 for PFM, in the byte order given by the sign of scale.
+     */
+    int sampleBytes() const;
+
+    /** @brief True if the last channel is alpha (a PAM tuple type ending in _ALPHA). */
+    bool hasAlpha() const;
+
+    /**
+     * @brief Header for channels samples per pixel in a format of the given
+     *        family: P2/P3 for ASCII, P5/P6 for binary, P7 if pam or for any
+     *        other channel count (tuple type GRAYSCALE, RGB or their _ALPHA
+     *        forms).
+     */
+    static PnmHeader forChannels(int channels, bool binary, bool pam = false);
+
+    /**
+     * @brief This header in the family forChannels() picks, with dimensions,
+     *        max value and comments kept, and the tuple type too if it stays P7.
+     * @throws runtime_error for PFM, whose float samples have no integer form.
+     */
+    PnmHeader converted(bool binary, bool pam) const;
+};
+
+#endif // !PNM_HPP
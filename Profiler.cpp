@@ -0,0 +1,219 @@
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+#include "Profiler.hpp"
+
+Profiler::Scope::Scope(Profiler* profiler, Phase phase, long long pixels)
+    : profiler_(profiler), phase_(phase) {
+    if (profiler_) {
+        profiler_->pixels_[phase_] += pixels;
+        if (profiler_->trace_) profiler_->trace_->begin(phaseName(phase_));
+        if (profiler_->counters_) counters_ = profiler_->counters_->read();
+        if (profiler_->memory_) {
+            memory_ = MemoryStats::snapshot();
+            MemoryStats::resetPeak();
+        }
+        start_ = Clock::now();
+    }
+}
+
+Profiler::Scope::~Scope() {
+    if (profiler_) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_);
+        if (profiler_->counters_) {
+            PerfCounters::Values now = profiler_->counters_->read();
+            for (int e = 0; e < PerfCounters::EventCount; ++e)
+                profiler_->counts_[phase_][e] += now[e] - counters_[e];
+        }
+        if (profiler_->memory_) {
+            MemoryStats::Snapshot now = MemoryStats::snapshot();
+            profiler_->allocations_[phase_] += now.allocations - memory_.allocations;
+            profiler_->allocatedBytes_[phase_] += now.bytesAllocated - memory_.bytesAllocated;
+            profiler_->peakGrowth_[phase_] = std::max(profiler_->peakGrowth_[phase_],
+                                                      now.peakLiveBytes - memory_.liveBytes);
+            profiler_->peakRss_[phase_] = std::max(profiler_->peakRss_[phase_], MemoryStats::currentRss());
+        }
+        profiler_->add(phase_, ns.count());
+        if (profiler_->trace_) profiler_->trace_->end(phaseName(phase_));
+    }
+}
+
+const char* Profiler::phaseName(Phase phase) {
+    static const char* const names[PhaseCount] = {
+        "load", "energy", "forward", "backtrack", "remove", "transpose", "write"
+    };
+    return names[phase];
+}
+
+void Profiler::setTrace(Trace* trace) { trace_ = trace; }
+Trace* Profiler::trace() const { return trace_; }
+
+void Profiler::setCounters(PerfCounters* counters) { counters_ = counters; }
+void Profiler::setMemoryTracking(bool enabled) { memory_ = enabled; }
+std::uint64_t Profiler::allocations(Phase phase) const { return allocations_[phase]; }
+std::int64_t Profiler::peakGrowth(Phase phase) const { return peakGrowth_[phase]; }
+void Profiler::addPixels(Phase phase, long long pixels) { pixels_[phase] += pixels; }
+
+std::uint64_t Profiler::counter(Phase phase, PerfCounters::Event event) const {
+    return counts_[phase][event];
+}
+
+void Profiler::add(Phase phase, long long ns) { samples_[phase].push_back(ns); }
+void Profiler::addSeam() { ++seams_; }
+long long Profiler::seams() const { return seams_; }
+std::size_t Profiler::count(Phase phase) const { return samples_[phase].size(); }
+
+long long Profiler::pixels(Phase phase) const { return pixels_[phase]; }
+
+double Profiler::total(Phase phase) const {
+    long long sum = 0;
+    for (long long ns : samples_[phase]) sum += ns;
+    return sum * 1e-9;
+}
+
+/**
+ * @brief Nearest-rank percentile of the samples of a phase.
+ */
+double Profiler::percentile(Phase phase, double p) const {
+    const auto& s = samples_[phase];
+    if (s.empty()) return 0.0;
+    std::vector<long long> sorted(s);
+    std::size_t rank = std::size_t(std::ceil(p / 100.0 * sorted.size()));
+    std::size_t k = std::min(sorted.size() - 1, rank ? rank - 1 : 0);
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k] * 1e-9;
+}
+
+/**
+ * @brief Table with total, share, mean, p50 and p99 for each phase that ran.
+ */
+void Profiler::report(std::ostream& out) const {
+    double all = 0, carve = 0;
+    for (int p = 0; p < PhaseCount; ++p) {
+        all += total(Phase(p));
+        if (p != Load && p != Write) carve += total(Phase(p));
+    }
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(3)
+        << "total " << all * 1e3 << " ms, " << seams_ << " seams";
+    if (seams_) out << ", " << carve * 1e6 / seams_ << " us/seam";
+    out << "\n"
+        << std::left << std::setw(10) << "phase" << std::right
+        << std::setw(8) << "calls" << std::setw(12) << "total ms" << std::setw(8) << "share"
+        << std::setw(12) << "mean us" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << "\n";
+    for (int p = 0; p < PhaseCount; ++p) {
+        Phase ph = Phase(p);
+        if (!count(ph)) continue;
+        double t = total(ph);
+        out << std::left << std::setw(10) << phaseName(ph) << std::right
+            << std::setw(8) << count(ph)
+            << std::setw(12) << t * 1e3
+            << std::setw(7) << std::setprecision(1) << (all > 0 ? 100 * t / all : 0.0) << "%"
+            << std::setprecision(3)
+            << std::setw(12) << t * 1e6 / count(ph)
+            << std::setw(12) << percentile(ph, 50) * 1e6
+            << std::setw(12) << percentile(ph, 99) * 1e6 << "\n";
+    }
+    if (memory_ && !MemoryStats::hooked()) {
+        out << "allocation counts unavailable (allocation hook not linked)\n";
+    } else if (memory_) {
+        std::uint64_t carveAllocs = 0;
+        for (int p = 0; p < PhaseCount; ++p)
+            if (p != Load && p != Write) carveAllocs += allocations_[p];
+        out << "\n" << std::setprecision(1);
+        if (seams_) out << double(carveAllocs) / seams_ << " allocations/seam, ";
+        out << "peak RSS " << MemoryStats::peakRss() / 1048576.0 << " MiB\n"
+            << std::left << std::setw(10) << "phase" << std::right
+            << std::setw(12) << "allocs" << std::setw(12) << "allocs/call"
+            << std::setw(14) << "allocated MiB" << std::setw(16) << "peak growth KiB"
+            << std::setw(10) << "RSS MiB" << "\n";
+        for (int p = 0; p < PhaseCount; ++p) {
+            Phase ph = Phase(p);
+            if (!count(ph)) continue;
+            out << std::left << std::setw(10) << phaseName(ph) << std::right
+                << std::setw(12) << allocations_[ph]
+                << std::setw(12) << double(allocations_[ph]) / count(ph)
+                << std::setw(14) << allocatedBytes_[ph] / 1048576.0
+                << std::setw(16) << peakGrowth_[ph] / 1024.0
+                << std::setw(10) << peakRss_[ph] / 1048576.0 << "\n";
+        }
+    }
+    if (counters_ && !counters_->available()) {
+        out << "hardware counters unavailable (perf_event_open failed)\n";
+    } else if (counters_) {
+        out << "\n" << std::left << std::setw(10) << "phase" << std::right
+            << std::setw(8) << "IPC" << std::setw(12) << "cycles/px";
+        for (int e = PerfCounters::L1DMisses; e < PerfCounters::EventCount; ++e)
+            out << std::setw(16) << (std::string(PerfCounters::eventName(PerfCounters::Event(e))) + "/px");
+        out << "\n";
+        for (int p = 0; p < PhaseCount; ++p) {
+            Phase ph = Phase(p);
+            if (!count(ph)) continue;
+            double px = double(std::max(1LL, pixels_[ph]));
+            double cycles = double(counts_[ph][PerfCounters::Cycles]);
+            out << std::left << std::setw(10) << phaseName(ph) << std::right << std::setprecision(2)
+                << std::setw(8) << (cycles > 0 ? counts_[ph][PerfCounters::Instructions] / cycles : 0.0)
+                << std::setw(12) << cycles / px << std::setprecision(4);
+            for (int e = PerfCounters::L1DMisses; e < PerfCounters::EventCount; ++e) {
+                if (counters_->valid(PerfCounters::Event(e))) out << std::setw(16) << counts_[ph][e] / px;
+                else                                          out << std::setw(16) << "n/a";
+            }
+            out << "\n";
+        }
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+/**
+ * @brief JSON object {"total_ms", "seams", "per_seam_us", "phases": {...}}.
+ */
+void Profiler::reportJson(std::ostream& out) const {
+    double all = 0, carve = 0;
+    for (int p = 0; p < PhaseCount; ++p) {
+        all += total(Phase(p));
+        if (p != Load && p != Write) carve += total(Phase(p));
+    }
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(3)
+        << "{\n  \"total_ms\": " << all * 1e3
+        << ",\n  \"seams\": " << seams_
+        << ",\n  \"per_seam_us\": " << (seams_ ? carve * 1e6 / seams_ : 0.0);
+    if (memory_ && MemoryStats::hooked()) out << ",\n  \"peak_rss_bytes\": " << MemoryStats::peakRss();
+    out << ",\n  \"phases\": {";
+    bool first = true;
+    for (int p = 0; p < PhaseCount; ++p) {
+        Phase ph = Phase(p);
+        if (!count(ph)) continue;
+        out << (first ? "\n" : ",\n") << "    \"" << phaseName(ph) << "\": {"
+            << "\"calls\": " << count(ph)
+            << ", \"total_ms\": " << total(ph) * 1e3
+            << ", \"mean_us\": " << total(ph) * 1e6 / count(ph)
+            << ", \"p50_us\": " << percentile(ph, 50) * 1e6
+            << ", \"p99_us\": " << percentile(ph, 99) * 1e6;
+        if (memory_ && MemoryStats::hooked()) {
+            out << ", \"allocations\": " << allocations_[ph]
+                << ", \"allocated_bytes\": " << allocatedBytes_[ph]
+                << ", \"peak_growth_bytes\": " << peakGrowth_[ph]
+                << ", \"rss_bytes\": " << peakRss_[ph];
+        }
+        if (counters_ && counters_->available()) {
+            out << ", \"pixels\": " << pixels_[ph];
+            for (int e = 0; e < PerfCounters::EventCount; ++e) {
+                if (counters_->valid(PerfCounters::Event(e)))
+                    out << ", \"" << PerfCounters::eventName(PerfCounters::Event(e)) << "\": " << counts_[ph][e];
+            }
+        }
+        out << "}";
+        first = false;
+    }
+    out << "\n  }\n}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,125 @@
+#include <vector>
+#include <chrono>
+#include <iosfwd>
+#include "Trace.hpp"
+#include "PerfCounters.hpp"
+#include "MemoryStats.hpp"
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+/**
+ * @class Profiler
+ * @brief Per-phase wall time accumulators for the carve pipeline.
+ *
+ * Every timed section adds one sample to its phase, so totals, means and
+ * percentiles are available afterwards. Passing a null Profiler to a Scope
+ * turns timing off without touching the clock. With a Trace attached, each
+ * timed section is also emitted as a begin/end trace event; with
+ * PerfCounters attached, hardware counter deltas are accumulated per phase
+ * and reported per pixel. With memory tracking on, heap allocations, heap
+ * growth and resident set size are recorded per phase as well.
+ */
+class Profiler {
+public:
+    enum Phase { Load, Energy, Forward, Backtrack, Remove, Transpose, Write, PhaseCount };
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @class Scope
+     * @brief Times the enclosing block into one phase of a (possibly null) Profiler.
+     */
+    class Scope {
+    private:
+        Profiler* profiler_;
+        Phase phase_;
+        Clock::time_point start_;
+        PerfCounters::Values counters_;
+        MemoryStats::Snapshot memory_;
+
+    public:
+        /**
+         * @param pixels Pixels processed in this section, for per-pixel counter rates.
+         */
+        Scope(Profiler* profiler, Phase phase, long long pixels = 0);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    std::vector<long long> samples_[PhaseCount]; // nanoseconds
+    long long seams_ = 0;
+    Trace* trace_ = nullptr;
+    PerfCounters* counters_ = nullptr;
+    PerfCounters::Values counts_[PhaseCount] = {};
+    long long pixels_[PhaseCount] = {};
+    bool memory_ = false;
+    std::uint64_t allocations_[PhaseCount] = {}, allocatedBytes_[PhaseCount] = {};
+    std::int64_t peakGrowth_[PhaseCount] = {}, peakRss_[PhaseCount] = {};
+
+public:
+    /** @brief Lower-case name of a phase. */
+    static const char* phaseName(Phase phase);
+
+    /** @brief Also emit phases as trace events (nullptr disables). Not owned. */
+    void setTrace(Trace* trace);
+
+    /** @brief Attached trace, or nullptr. */
+    Trace* trace() const;
+
+    /** @brief Accumulate hardware counters per phase (nullptr disables). Not owned. */
+    void setCounters(PerfCounters* counters);
+
+    /**
+     * @brief Record allocations (needs the AllocHook in the executable) and
+     *        resident set size per phase.
+     */
+    void setMemoryTracking(bool enabled);
+
+    /** @brief Add pixels processed by a phase (for per-pixel counter rates). */
+    void addPixels(Phase phase, long long pixels);
+
+    /** @brief Record one sample of `ns` nanoseconds for a phase. */
+    void add(Phase phase, long long ns);
+
+    /** @brief Count one removed seam (for per-seam means). */
+    void addSeam();
+
+    /** @brief Number of seams counted so far. */
+    long long seams() const;
+
+    /** @brief Number of samples recorded for a phase. */
+    std::size_t count(Phase phase) const;
+
+    /** @brief Pixels processed in a phase, the divisor of its per-pixel figures. */
+    long long pixels(Phase phase) const;
+
+    /** @brief Sum of all samples of a phase, in seconds. */
+    double total(Phase phase) const;
+
+    /**
+     * @brief Percentile of the samples of a phase, in seconds.
+     * @param p Percentile in [0, 100].
+     */
+    double percentile(Phase phase, double p) const;
+
+    /** @brief Accumulated counter delta of one event in one phase. */
+    std::uint64_t counter(Phase phase, PerfCounters::Event event) const;
+
+    /** @brief Heap allocations made during a phase. */
+    std::uint64_t allocations(Phase phase) const;
+
+    /** @brief Largest heap growth above the level at phase start, in bytes. */
+    std::int64_t peakGrowth(Phase phase) const;
+
+    /** @brief Human-readable table of all phases. */
+    void report(std::ostream& out) const;
+
+    /** @brief Same data as report() as a JSON object. */
+    void reportJson(std::ostream& out) const;
+};
+
+#endif // !PROFILER_HPP
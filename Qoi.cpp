@@ -0,0 +1,242 @@
+#include <vector>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include "Qoi.hpp"
+
+namespace {
+
+const unsigned char kOpIndex = 0x00, kOpDiff = 0x40, kOpLuma = 0x80, kOpRun = 0xc0;
+const unsigned char kOpRgb = 0xfe, kOpRgba = 0xff;
+const unsigned char kEndMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+const int kMaxRun = 62;
+
+// I/O block of the codec
+const std::size_t kBlock = 1 << 16;
+
+struct Rgba {
+    unsigned char r, g, b, a;
+    bool operator==(const Rgba& o) const { return r == o.r && g == o.g && b == o.b && a == o.a; }
+};
+
+inline int hashOf(const Rgba& p) { return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64; }
+
+/**
+ * @brief Block reader that never reads past the bytes the image still needs:
+ *        at least one per run of the remaining pixels plus the end marker.
+ */
+class ChunkReader {
+private:
+    std::istream& in_;
+    std::vector<unsigned char> buf_;
+    std::size_t pos_ = 0, end_ = 0;
+
+public:
+    explicit ChunkReader(std::istream& in) : in_(in), buf_(kBlock) {}
+
+    /** @brief Make n bytes available with remaining pixels still to decode. */
+    const unsigned char* need(std::size_t n, long long remaining) {
+        if (end_ - pos_ >= n) return buf_.data() + pos_;
+        const std::size_t left = end_ - pos_;
+        std::memmove(buf_.data(), buf_.data() + pos_, left);
+        pos_ = 0;
+        end_ = left;
+        const long long floor = (remaining + kMaxRun - 1) / kMaxRun + sizeof kEndMarker;
+        const std::size_t want = std::size_t(std::min<long long>(floor, (long long)kBlock)) - left;
+        in_.read(reinterpret_cast<char*>(buf_.data() + end_), want);
+        end_ += std::size_t(in_.gcount());
+        if (end_ < n) throw std::runtime_error("Truncated QOI data");
+        return buf_.data();
+    }
+
+    void skip(std::size_t n) { pos_ += n; }
+};
+
+template <int C>
+void decodeChunks(std::istream& in, long long pixels, int* dst) {
+    ChunkReader reader(in);
+    Rgba index[64] = {};
+    Rgba px = { 0, 0, 0, 255 };
+    int run = 0;
+    for (long long p = 0; p < pixels; ++p, dst += C) {
+        if (run > 0) {
+            --run;
+        } else {
+            // the longest chunk is five bytes
+            const unsigned char* b = reader.need(5, pixels - p);
+            const unsigned char op = b[0];
+            if (op == kOpRgb) {
+                px.r = b[1]; px.g = b[2]; px.b = b[3];
+                reader.skip(4);
+            } else if (op == kOpRgba) {
+                px.r = b[1]; px.g = b[2]; px.b = b[3]; px.a = b[4];
+                reader.skip(5);
+            } else if ((op & 0xc0) == kOpIndex) {
+                px = index[op];
+                reader.skip(1);
+            } else if ((op & 0xc0) == kOpDiff) {
+                px.r += ((op >> 4) & 3) - 2;
+                px.g += ((op >> 2) & 3) - 2;
+                px.b += (op & 3) - 2;
+                reader.skip(1);
+            } else if ((op & 0xc0) == kOpLuma) {
+                const int dg = (op & 0x3f) - 32;
+                px.r += dg - 8 + ((b[1] >> 4) & 0x0f);
+                px.g += dg;
+                px.b += dg - 8 + (b[1] & 0x0f);
+                reader.skip(2);
+            } else {
+                run = op & 0x3f;
+                reader.skip(1);
+            }
+            index[hashOf(px)] = px;
+        }
+        dst[0] = px.r;
+        dst[1] = px.g;
+        dst[2] = px.b;
+        if (C == 4) dst[3] = px.a;
+    }
+    const unsigned char* marker = reader.need(sizeof kEndMarker, 0);
+    if (std::memcmp(marker, kEndMarker, sizeof kEndMarker) != 0)
+        throw std::runtime_error("Missing QOI end marker");
+}
+
+/**
+ * @brief Pixel p of an image with channels ints per pixel, as RGBA.
+ */
+template <int Channels>
+inline Rgba pixelAt(const int* src) {
+    auto sample = [](int v) {
+        if (v < 0 || v > 255) throw std::runtime_error("QOI needs samples of at most 255");
+        return (unsigned char)v;
+    };
+    if (Channels <= 2) {
+        const unsigned char g = sample(src[0]);
+        return { g, g, g, Channels == 2 ? sample(src[1]) : (unsigned char)255 };
+    }
+    return { sample(src[0]), sample(src[1]), sample(src[2]),
+             Channels == 4 ? sample(src[3]) : (unsigned char)255 };
+}
+
+template <int Channels>
+void encodeChunks(std::ostream& out, long long pixels, const int* src) {
+    std::vector<unsigned char> buf(kBlock);
+    std::size_t n = 0;
+    Rgba index[64] = {};
+    Rgba prev = { 0, 0, 0, 255 };
+    int run = 0;
+    for (long long p = 0; p < pixels; ++p, src += Channels) {
+        // room for a run and the longest chunk
+        if (n + 6 > buf.size()) {
+            out.write(reinterpret_cast<const char*>(buf.data()), n);
+            n = 0;
+        }
+        const Rgba px = pixelAt<Channels>(src);
+        if (px == prev) {
+            if (++run == kMaxRun) {
+                buf[n++] = kOpRun | (run - 1);
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            buf[n++] = kOpRun | (run - 1);
+            run = 0;
+        }
+        const int h = hashOf(px);
+        if (index[h] == px) {
+            buf[n++] = kOpIndex | h;
+        } else {
+            index[h] = px;
+            if (px.a == prev.a) {
+                const signed char dr = (signed char)(px.r - prev.r);
+                const signed char dg = (signed char)(px.g - prev.g);
+                const signed char db = (signed char)(px.b - prev.b);
+                const int drg = dr - dg, dbg = db - dg;
+                if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2) {
+                    buf[n++] = kOpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+                } else if (drg > -9 && drg < 8 && dg > -33 && dg < 32 && dbg > -9 && dbg < 8) {
+                    buf[n++] = kOpLuma | (dg + 32);
+                    buf[n++] = (unsigned char)((drg + 8) << 4 | (dbg + 8));
+                } else {
+                    buf[n++] = kOpRgb;
+                    buf[n++] = px.r; buf[n++] = px.g; buf[n++] = px.b;
+                }
+            } else {
+                buf[n++] = kOpRgba;
+                buf[n++] = px.r; buf[n++] = px.g; buf[n++] = px.b; buf[n++] = px.a;
+            }
+        }
+        prev = px;
+    }
+    if (run > 0) buf[n++] = kOpRun | (run - 1);
+    out.write(reinterpret_cast<const char*>(buf.data()), n);
+    out.write(reinterpret_cast<const char*>(kEndMarker), sizeof kEndMarker);
+}
+
+} // namespace
+
+/**
+ * @brief Parse the 14-byte header.
+ * @throws runtime_error on a truncated or invalid header.
+ */
+QoiHeader QoiHeader::read(std::istream& in) {
+    unsigned char b[14];
+    if (!in.read(reinterpret_cast<char*>(b), sizeof b)) throw std::runtime_error("Truncated QOI header");
+    if (std::memcmp(b, "qoif", 4) != 0) throw std::runtime_error("Invalid magic (expected qoif)");
+    auto be32 = [](const unsigned char* p) {
+        return std::uint32_t(p[0]) << 24 | std::uint32_t(p[1]) << 16 | std::uint32_t(p[2]) << 8 | p[3];
+    };
+    const std::uint32_t width = be32(b + 4), height = be32(b + 8);
+    QoiHeader h;
+    h.channels = b[12];
+    h.colorspace = b[13];
+    if (width == 0 || height == 0 || width > 0x7fffffff || height > 0x7fffffff)
+        throw std::runtime_error("Invalid dimensions");
+    if ((h.channels != 3 && h.channels != 4) || h.colorspace > 1)
+        throw std::runtime_error("Invalid QOI channels or colorspace");
+    h.width = int(width);
+    h.height = int(height);
+    return h;
+}
+
+void QoiHeader::write(std::ostream& out) const {
+    unsigned char b[14] = { 'q', 'o', 'i', 'f' };
+    for (int k = 0; k < 4; ++k) {
+        b[4 + k] = (unsigned char)(std::uint32_t(width) >> (24 - 8 * k));
+        b[8 + k] = (unsigned char)(std::uint32_t(height) >> (24 - 8 * k));
+    }
+    b[12] = (unsigned char)channels;
+    b[13] = (unsigned char)colorspace;
+    out.write(reinterpret_cast<const char*>(b), sizeof b);
+}
+
+/**
+ * @brief Decode into pixels, compiled once per channel count.
+ * @throws runtime_error on truncated or malformed data.
+ */
+void QoiCodec::decode(std::istream& in, const QoiHeader& header, int* pixels) {
+    const long long count = (long long)header.width * header.height;
+    if (header.channels == 4) decodeChunks<4>(in, count, pixels);
+    else                      decodeChunks<3>(in, count, pixels);
+}
+
+/**
+ * @brief Encode pixels of 1 to 4 channels, compiled once per channel count.
+ * @throws runtime_error on a sample outside 0-255.
+ */
+void QoiCodec::encode(std::ostream& out, const QoiHeader& header, const int* pixels, int channels) {
+    const long long count = (long long)header.width * header.height;
+    if (channels < 1 || channels > 4 || (header.channels == 4) != (channels % 2 == 0))
+        throw std::runtime_error("QOI holds RGB or RGBA pixels");
+    header.write(out);
+    switch (channels) {
+    case 1:  encodeChunks<1>(out, count, pixels); break;
+    case 2:  encodeChunks<2>(out, count, pixels); break;
+    case 3:  encodeChunks<3>(out, count, pixels); break;
+    default: encodeChunks<4>(out, count, pixels); break;
+    }
+}
@@ -0,0 +1,54 @@
+#include <cstddef>
+#include <iosfwd>
+
+#ifndef QOI_HPP
+#define QOI_HPP
+
+/**
+ * @struct QoiHeader
+ * @brief 14-byte header of a QOI ("Quite OK Image") file: the magic "qoif",
+ *        big endian width and height, 3 (RGB) or 4 (RGBA) channels and a
+ *        colorspace byte (0 sRGB with linear alpha, 1 all linear) that is
+ *        only carried along.
+ */
+struct QoiHeader {
+    int width = 0, height = 0;
+    int channels = 3;
+    int colorspace = 0;
+
+    /**
+     * @brief Parse a header, magic included.
+     * @throws runtime_error on a truncated or invalid header.
+     */
+    static QoiHeader read(std::istream& in);
+
+    /** @brief Write the 14 header bytes. */
+    void write(std::ostream& out) const;
+};
+
+/**
+ * @class QoiCodec
+ * @brief Lossless encoder and decoder of the QOI chunk stream for 8-bit
+ *        samples held as ints, channels ints per pixel.
+ */
+class QoiCodec {
+public:
+    /**
+     * @brief Decode the chunks and end marker following header straight into
+     *        pixels (width * height * header.channels ints). The stream is
+     *        read in blocks no larger than the rest of the image can need,
+     *        so nothing after the end marker is consumed.
+     * @throws runtime_error on truncated or malformed data.
+     */
+    static void decode(std::istream& in, const QoiHeader& header, int* pixels);
+
+    /**
+     * @brief Encode width * height pixels of channels ints each, followed by
+     *        the end marker. Gray (1) and gray + alpha (2) pixels are written
+     *        as RGB(A) with equal color samples; header.channels must match.
+     * @throws runtime_error on a sample outside 0-255.
+     */
+    static void encode(std::ostream& out, const QoiHeader& header, const int* pixels, int channels);
+};
+
+#endif // !QOI_HPP
@@ -0,0 +1,67 @@
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include "SceneCut.hpp"
+
+/**
+ * @brief Normalized histogram of the gray values of a frame. Float frames
+ *        are binned over [0, 1], clamping HDR values to the top bin.
+ */
+SceneCutDetector::Histogram SceneCutDetector::histogram(const Image& frame) {
+    std::array<long long, kBins> counts = {};
+    const int w = frame.getWidth(), h = frame.getHeight();
+    const long long range = (long long)frame.getMaxValue() + 1;
+    frame.visitChannels([&](auto channels) {
+        const int C = channels;
+        for (int i = 0; i < h; ++i) {
+            const int* row = frame.rowData(i);
+            if (frame.isFloat()) {
+                for (int j = 0; j < w; ++j) {
+                    const int* p = row + std::size_t(j) * C;
+                    float gray = 0;
+                    for (int c = 0; c < C; ++c) gray += sampleFloat(p[c]);
+                    gray /= C;
+                    // also sends NaN to the first bin
+                    const int bin = gray > 0 ? int(std::min(gray, 1.0f) * (kBins - 1)) : 0;
+                    ++counts[bin];
+                }
+                continue;
+            }
+            for (int j = 0; j < w; ++j) {
+                const long long gray = grayPixel(row + std::size_t(j) * C, channels);
+                ++counts[std::min<long long>(kBins - 1, std::max(0LL, gray) * kBins / range)];
+            }
+        }
+    });
+    Histogram hist;
+    const double pixels = double(w) * h;
+    for (int b = 0; b < kBins; ++b) hist[b] = float(counts[b] / pixels);
+    return hist;
+}
+
+/**
+ * @brief Half the L1 distance of two normalized histograms.
+ */
+double SceneCutDetector::difference(const Histogram& a, const Histogram& b) {
+    double sum = 0;
+    for (int k = 0; k < kBins; ++k) sum += std::fabs(double(a[k]) - b[k]);
+    return sum / 2;
+}
+
+SceneCutDetector::SceneCutDetector(double threshold) : threshold_(threshold) {}
+
+/**
+ * @brief Feed the next frame; true if it starts a new scene.
+ */
+bool SceneCutDetector::isCut(const Image& frame) {
+    if (threshold_ <= 0) return false;
+    Histogram hist = histogram(frame);
+    bool cut = havePrevious_ && difference(previous_, hist) > threshold_;
+    previous_ = hist;
+    havePrevious_ = true;
+    return cut;
+}
+
+void SceneCutDetector::reset() { havePrevious_ = false; }
+
+double SceneCutDetector::threshold() const { return threshold_; }
@@ -0,0 +1,51 @@
+#include <array>
+#include "Image.hpp"
+
+#ifndef SCENECUT_HPP
+#define SCENECUT_HPP
+
+/**
+ * @class SceneCutDetector
+ * @brief Detects scene cuts from the change of the luminance histogram
+ *        between consecutive frames.
+ *
+ * The difference of two frames is half the L1 distance of their normalized
+ * histograms: 0 for identical brightness distributions, 1 for disjoint ones.
+ * Camera and object motion barely move the histogram, a cut usually does.
+ */
+class SceneCutDetector {
+public:
+    static const int kBins = 64;
+    using Histogram = std::array<float, kBins>;
+
+    /** @brief Normalized histogram of the gray values of a frame. */
+    static Histogram histogram(const Image& frame);
+
+    /** @brief Difference of two histograms in [0, 1]. */
+    static double difference(const Histogram& a, const Histogram& b);
+
+private:
+    double threshold_;
+    Histogram previous_ = {};
+    bool havePrevious_ = false;
+
+public:
+    /**
+     * @param threshold Histogram difference above which a frame starts a new
+     *                  scene; 0 or less disables detection.
+     */
+    explicit SceneCutDetector(double threshold = 0.35);
+
+    /**
+     * @brief Feed the next frame.
+     * @return true if the frame starts a new scene (never for the first frame).
+     */
+    bool isCut(const Image& frame);
+
+    /** @brief Forget the previous frame. */
+    void reset();
+
+    double threshold() const;
+};
+
+#endif // !SCENECUT_HPP
@@ -1,78 +1,567 @@
 #include <vector>
+#include <string>
 #include <array>
 #include <algorithm>
 #include <limits>
+#include <stdexcept>
 #include <cstdlib>
+#include <type_traits>
+#include <utility>
 #include "Image.hpp"
 #include "SeamCarver.hpp"
+#include "ThreadPool.hpp"
+#include "Profiler.hpp"
+#include "Kernels.hpp"
+#include "Matrix.hpp"
+#include "Trace.hpp"
+
+namespace {
+
+// Below this many columns (or rows) per thread, synchronization costs more than it saves.
+const int kMinWorkPerThread = 128;
+
+// Largest energy of one pixel: four differences of at most the max value.
+const long long kEnergyPerMaxValue = 4;
+
+/**
+ * @brief Cost of cells outside a band; above every seam cost the cost type is
+ *        chosen for, with room to add an energy without overflow.
+ */
+template <typename Cost>
+constexpr Cost outsideBand() { return std::numeric_limits<Cost>::max() / 2; }
+
+inline void costRow(const KernelTable& k, const int* prev, const int* energy, int* out,
+                    int first, int last, int width) {
+    k.costRow(prev, energy, out, first, last, width);
+}
+
+inline void costRow(const KernelTable& k, const long long* prev, const int* energy, long long* out,
+                    int first, int last, int width) {
+    k.costRowWide(prev, energy, out, first, last, width);
+}
+
+inline void costRow(const KernelTable& k, const float* prev, const float* energy, float* out,
+                    int first, int last, int width) {
+    k.costRowF(prev, energy, out, first, last, width);
+}
+
+inline void energyRow(const KernelTable& k, const int* up, const int* cur, const int* down,
+                      int* out, int width) {
+    k.energyRow(up, cur, down, out, width);
+}
+
+inline void energyRow(const KernelTable& k, const float* up, const float* cur, const float* down,
+                      float* out, int width) {
+    k.energyRowF(up, cur, down, out, width);
+}
+
+/**
+ * @brief Column in row prev that the cheapest path into column j comes from,
+ *        the leftmost on ties, as the backtrack chooses it.
+ */
+template <typename Cost>
+inline int cheapestAbove(const Cost* prev, int j, int w) {
+    const int start = j > 0 ? j - 1 : 0, end = j + 1 < w ? j + 1 : j;
+    int best = start;
+    for (int c = start + 1; c <= end; ++c)
+        if (prev[c] < prev[best]) best = c;
+    return best;
+}
+
+} // namespace
+
+/**
+ * @brief Band cells summed over the rows, or the full image.
+ */
+long long SeamCarver::passPixels(const Band* band, int width, int height) {
+    if (!band) return (long long)width * height;
+    long long pixels = 0;
+    for (std::size_t i = 0; i < band->first.size(); ++i) pixels += band->last[i] - band->first[i];
+    return pixels;
+}
+
+/**
+ * @brief Number of threads worth using for `work` independent items.
+ */
+int SeamCarver::threadsFor(int work) const {
+    if (!pool_) return 1;
+    return std::max(1, std::min(pool_->size(), work / kMinWorkPerThread));
+}
 
 /**
  * @brief Compute energy map 
  */
-std::vector<std::vector<int>> SeamCarver::computeEnergy() const {
-   int h = image_.getHeight(), w = image_.getWidth();
-    std::vector<std::vector<int>> E(h, std::vector<int>(w));
-    for (int i = 0; i < h; ++i) {
-        for (int j = 0; j < w; ++j) {
-            int sum = 0;
-            // for grayscale or average
-            int v = image_.grayValue(i, j);
-            if (i > 0)   sum += std::abs(v - image_.grayValue(i - 1, j));
-            if (i < h-1) sum += std::abs(v - image_.grayValue(i + 1, j));
-            if (j > 0)   sum += std::abs(v - image_.grayValue(i, j - 1));
-            if (j < w-1) sum += std::abs(v - image_.grayValue(i, j + 1));
-            E[i][j] = sum;
+Matrix<int> SeamCarver::computeEnergy() const {
+    if (image_.isFloat()) throw std::runtime_error("Float images have float energies");
+    Matrix<int> E;
+    computeEnergy(E);
+    return E;
+}
+
+/**
+ * @brief Gray values of n pixels, through the kernel unless a channel subset is set.
+ */
+void SeamCarver::grayRow(const int* src, int* dst, int n) const {
+    const int C = image_.getChannels();
+    if (energyChannels_.empty()) {
+        Kernels::get().grayRow(src, dst, n, C);
+        return;
+    }
+    const int* use = energyChannels_.data();
+    const int count = int(energyChannels_.size());
+    for (int j = 0; j < n; ++j) {
+        const int* p = src + std::size_t(j) * C;
+        int sum = 0;
+        for (int c = 0; c < count; ++c) sum += p[use[c]];
+        dst[j] = sum / count;
+    }
+}
+
+/**
+ * @brief Float gray values of n pixels of a float image.
+ */
+void SeamCarver::grayRow(const int* src, float* dst, int n) const {
+    const int C = image_.getChannels();
+    if (energyChannels_.empty()) {
+        Kernels::get().grayRowF(src, dst, n, C);
+        return;
+    }
+    const int* use = energyChannels_.data();
+    const int count = int(energyChannels_.size());
+    for (int j = 0; j < n; ++j) {
+        const int* p = src + std::size_t(j) * C;
+        float sum = 0;
+        for (int c = 0; c < count; ++c) sum += sampleFloat(p[use[c]]);
+        dst[j] = sum / count;
+    }
+}
+
+/**
+ * @brief Keep a gray plane when samples fit 16 bits and there is a conversion
+ *        to save. Gray images, 16-bit ones included, read their int rows: the
+ *        plane speeds their energy pass by under 10% but costs a second copy
+ *        to remove seams from and transpose, a net loss of about a third.
+ */
+bool SeamCarver::useGrayPlane() const {
+    return grayPlane_ && !image_.isFloat() && image_.getMaxValue() <= 65535
+        && image_.getChannels() > 1;
+}
+
+/**
+ * @brief Fill gray_ from the image, in parallel over rows.
+ */
+void SeamCarver::buildGray() {
+    const int h = image_.getHeight(), w = image_.getWidth(), C = image_.getChannels();
+    const KernelTable& k = Kernels::get();
+    gray_.resize(h, w);
+    auto rows = [&](int first, int last) {
+        std::vector<int> buf(energyChannels_.empty() ? 0 : w);
+        for (int i = first; i < last; ++i) {
+            if (energyChannels_.empty()) {
+                k.grayRow16(image_.rowData(i), gray_.row(i), w, C);
+                continue;
+            }
+            grayRow(image_.rowData(i), buf.data(), w);
+            std::copy(buf.begin(), buf.end(), gray_.row(i));
         }
+    };
+    int threads = threadsFor(h);
+    if (threads == 1) {
+        rows(0, h);
+    } else {
+        pool_->run(threads, [&](int t, int n) {
+            rows(int((long long)h * t / n), int((long long)h * (t + 1) / n));
+        });
     }
-    return E;
+    grayValid_ = true;
+}
+
+void SeamCarver::transposeImage() {
+    Profiler::Scope scope(profiler_, Profiler::Transpose,
+                          (long long)image_.getWidth() * image_.getHeight());
+    image_.transpose();
+    if (!grayValid_) return;
+    grayScratch_.resize(gray_.cols(), gray_.rows());
+    Kernels::get().transpose16(gray_.row(0), grayScratch_.row(0), gray_.rows(), gray_.cols());
+    std::swap(gray_, grayScratch_);
 }
 
 /**
- * @brief Find min-energy vertical seam 
+ * @brief Compute energy map into E. Color rows are reduced to gray in a
+ *        rolling three-row window, so each row is converted once per thread;
+ *        only integer gray images are read directly. With a band, each row
+ *        is computed over the band plus one column of context per side.
  */
-std::vector<int> SeamCarver::findVerticalSeam(const std::vector<std::vector<int>>& energy) const {
-    int h = energy.size();
-    int w = energy[0].size();
-    std::vector<std::vector<int>> M(h, std::vector<int>(w, std::numeric_limits<int>::max()));
-    for (int j = 0; j < w; ++j) M[0][j] = energy[0][j];
-    for (int i = 1; i < h; ++i) {
+template <typename Energy>
+void SeamCarver::computeEnergy(Matrix<Energy>& E, const Band* band) const {
+    Profiler::Scope scope(profiler_, Profiler::Energy,
+                          passPixels(band, image_.getWidth(), image_.getHeight()));
+    const int h = image_.getHeight(), w = image_.getWidth(), C = image_.getChannels();
+    const KernelTable& k = Kernels::get();
+    const bool direct = C == 1 && std::is_same<Energy, int>::value;
+    E.resize(h, w);
+    if constexpr (std::is_same<Energy, int>::value) if (grayValid_) {
+        // one plane row per image row, no conversion
+        auto plane = [&](int i) { return gray_.row(i < 0 ? 0 : i >= h ? h - 1 : i); };
+        if (band) {
+            for (int i = 0; i < h; ++i) {
+                int a = std::max(0, band->first[i] - 1), n = std::min(w, band->last[i] + 1) - a;
+                k.energyRow16(plane(i > 0 ? i - 1 : i) + a, plane(i) + a,
+                              plane(i < h - 1 ? i + 1 : i) + a, E.row(i) + a, n);
+            }
+            return;
+        }
+        auto rows = [&](int first, int last) {
+            for (int i = first; i < last; ++i)
+                k.energyRow16(plane(i > 0 ? i - 1 : i), plane(i), plane(i < h - 1 ? i + 1 : i),
+                              E.row(i), w);
+        };
+        int threads = threadsFor(h);
+        if (threads == 1) {
+            rows(0, h);
+        } else {
+            pool_->run(threads, [&](int t, int n) {
+                rows(int((long long)h * t / n), int((long long)h * (t + 1) / n));
+            });
+        }
+        return;
+    }
+    if (band) {
+        std::vector<Energy> buf(direct ? 0 : 3 * std::size_t(w));
+        for (int i = 0; i < h; ++i) {
+            // the context columns come out as image edges; they lie outside the band
+            int a = std::max(0, band->first[i] - 1), n = std::min(w, band->last[i] + 1) - a;
+            const int* src[3] = { image_.rowData(i > 0 ? i - 1 : i) + std::size_t(a) * C,
+                                  image_.rowData(i) + std::size_t(a) * C,
+                                  image_.rowData(i < h - 1 ? i + 1 : i) + std::size_t(a) * C };
+            const Energy* rows[3] = {};
+            for (int r = 0; r < 3; ++r) {
+                if constexpr (std::is_same<Energy, int>::value) rows[r] = src[r];
+                if (!direct) {
+                    grayRow(src[r], buf.data() + r * n, n);
+                    rows[r] = buf.data() + r * n;
+                }
+            }
+            energyRow(k, rows[0], rows[1], rows[2], E.row(i) + a, n);
+        }
+        return;
+    }
+    auto rows = [&](int first, int last) {
+        if constexpr (std::is_same<Energy, int>::value) if (direct) {
+            for (int i = first; i < last; ++i) {
+                const int* cur = image_.rowData(i);
+                // a missing neighbour is passed as cur itself and contributes 0
+                k.energyRow(i > 0 ? image_.rowData(i - 1) : cur, cur,
+                            i < h - 1 ? image_.rowData(i + 1) : cur, E.row(i), w);
+            }
+            return;
+        }
+        std::vector<Energy> buf(3 * std::size_t(w));
+        Energy* g[3] = { buf.data(), buf.data() + w, buf.data() + 2 * w }; // rows i-1, i, i+1
+        if (first > 0) grayRow(image_.rowData(first - 1), g[0], w);
+        grayRow(image_.rowData(first), g[1], w);
+        for (int i = first; i < last; ++i) {
+            if (i < h - 1) grayRow(image_.rowData(i + 1), g[2], w);
+            energyRow(k, i > 0 ? g[0] : g[1], g[1], i < h - 1 ? g[2] : g[1], E.row(i), w);
+            std::swap(g[0], g[1]);
+            std::swap(g[1], g[2]);
+        }
+    };
+    int threads = threadsFor(h);
+    if (threads == 1) {
+        rows(0, h);
+    } else {
+        pool_->run(threads, [&](int t, int n) {
+            rows(int((long long)h * t / n), int((long long)h * (t + 1) / n));
+        });
+    }
+}
+
+/**
+ * @brief Forward DP pass: cumulative minimum cost of reaching each pixel from the top row.
+ */
+template <typename Energy, typename Cost>
+void SeamCarver::cumulativeCost(const Matrix<Energy>& energy, Matrix<Cost>& M, const Band* band,
+                                Strips* strips) const {
+    Profiler::Scope scope(profiler_, Profiler::Forward, passPixels(band, energy.cols(), energy.rows()));
+    const int h = energy.rows(), w = energy.cols();
+    const KernelTable& k = Kernels::get();
+    M.resize(h, w);
+    if (band) {
+        for (int i = 0; i < h; ++i) {
+            int first = band->first[i], last = band->last[i];
+            if (i == 0) std::copy(energy.row(0) + first, energy.row(0) + last, M.row(0) + first);
+            else        costRow(k, M.row(i - 1), energy.row(i), M.row(i), first, last, w);
+            // the band moves at most one column per row, so the next row reads
+            // at most two columns beyond this one
+            std::fill(M.row(i) + std::max(0, first - 2), M.row(i) + first, outsideBand<Cost>());
+            std::fill(M.row(i) + last, M.row(i) + std::min(w, last + 2), outsideBand<Cost>());
+        }
+        return;
+    }
+    if (strips && !band && strips_ > 1 && pool_ && h >= 2 * strips_) {
+        stripCost(energy, M, *strips);
+        return;
+    }
+    std::copy(energy.row(0), energy.row(0) + w, M.row(0));
+    int threads = threadsFor(w);
+    if (threads == 1) {
+        for (int i = 1; i < h; ++i) costRow(k, M.row(i - 1), energy.row(i), M.row(i), 0, w, w);
+    } else {
+        // each thread owns a column band; row i needs all of row i-1
+        pool_->run(threads, [&](int t, int n) {
+            int first = int((long long)w * t / n), last = int((long long)w * (t + 1) / n);
+            for (int i = 1; i < h; ++i) {
+                costRow(k, M.row(i - 1), energy.row(i), M.row(i), first, last, w);
+                pool_->barrier();
+            }
+        });
+    }
+}
+
+/**
+ * @brief Strip-parallel forward pass.
+ *
+ * Each strip runs its own DP, warmed up on the overlap rows above it, and
+ * follows for every column the column its path entered the strip at and the
+ * cost accumulated before that. A sequential DP over the strips then adds
+ * the cost of the cheapest continuation above each entry, which is a few
+ * numbers per column and strip.
+ */
+template <typename Energy, typename Cost>
+void SeamCarver::stripCost(const Matrix<Energy>& energy, Matrix<Cost>& M, Strips& strips) const {
+    const int h = energy.rows(), w = energy.cols(), n = strips_;
+    const KernelTable& k = Kernels::get();
+    const std::size_t W = w;
+    strips.count = n;
+    strips.entry.resize(n * W);
+    strips.inner.resize(n * W);
+    strips.link.resize(n * W);
+    strips.total.resize(W);
+    pool_->run(std::min(n, pool_->size()), [&](int t, int threads) {
+        std::vector<Cost> scratch(3 * W);
+        std::vector<int> nextEntry(W);
+        for (int s = t; s < n; s += threads) {
+            const int first = int((long long)h * s / n), last = int((long long)h * (s + 1) / n);
+            const int start = std::max(0, first - stripOverlap_);
+            int* entry = strips.entry.data() + s * W;
+            Cost* base = scratch.data();       // path cost before entering the strip
+            Cost* nextBase = base + W;
+            if (start == first) {
+                std::copy(energy.row(first), energy.row(first) + w, M.row(first));
+                std::fill(base, base + w, Cost(0));
+            } else {
+                Cost* prev = nextBase;
+                Cost* cur = nextBase + W;
+                std::copy(energy.row(start), energy.row(start) + w, prev);
+                for (int i = start + 1; i < first; ++i) {
+                    costRow(k, prev, energy.row(i), cur, 0, w, w);
+                    std::swap(prev, cur);
+                }
+                costRow(k, prev, energy.row(first), M.row(first), 0, w, w);
+                for (int j = 0; j < w; ++j) base[j] = prev[cheapestAbove(prev, j, w)];
+            }
+            for (int j = 0; j < w; ++j) entry[j] = j;
+            for (int i = first + 1; i < last; ++i) {
+                const Cost* prev = M.row(i - 1);
+                costRow(k, prev, energy.row(i), M.row(i), 0, w, w);
+                for (int j = 0; j < w; ++j) {
+                    const int c = cheapestAbove(prev, j, w);
+                    nextEntry[j] = entry[c];
+                    nextBase[j] = base[c];
+                }
+                std::copy(nextEntry.begin(), nextEntry.begin() + w, entry);
+                std::swap(base, nextBase);
+            }
+            double* inner = strips.inner.data() + s * W;
+            for (int j = 0; j < w; ++j) inner[j] = double(M.row(last - 1)[j] - base[j]);
+        }
+    });
+    // reconciliation: cheapest connected continuation across each boundary
+    std::vector<double> above(strips.inner.begin(), strips.inner.begin() + W);
+    double* total = strips.total.data();
+    for (int s = 1; s < n; ++s) {
+        const int* entry = strips.entry.data() + s * W;
+        const double* inner = strips.inner.data() + s * W;
+        int* link = strips.link.data() + s * W;
         for (int j = 0; j < w; ++j) {
-            int best = M[i - 1][j];
-            if (j > 0)    best = std::min(best, M[i - 1][j - 1]);
-            if (j < w - 1) best = std::min(best, M[i - 1][j + 1]);
-            M[i][j] = energy[i][j] + best;
+            link[j] = cheapestAbove(above.data(), entry[j], w);
+            total[j] = inner[j] + above[link[j]];
         }
+        std::copy(total, total + w, above.begin());
     }
-    std::vector<int> seam(h);
-    int minj = 0;
-    for (int j = 1; j < w; ++j) {
-        if (M[h - 1][j] < M[h - 1][minj]) minj = j;
-    }
-    seam[h - 1] = minj;
-    for (int i = h - 1; i > 0; --i) {
-        int prev = seam[i];
-        int start = std::max(0, prev - 1);
-        int end = std::min(w - 1, prev + 1);
-        int best = start;
-        int val = M[i - 1][start];
-        for (int k = start + 1; k <= end; ++k) {
-            if (M[i - 1][k] < val) { val = M[i - 1][k]; best = k; }
+}
+
+/**
+ * @brief Backtrack the cheapest seam from the bottom row of the cost matrix.
+ */
+template <typename Cost>
+void SeamCarver::backtrackSeam(const Matrix<Cost>& M, std::vector<int>& seam, const Band* band,
+                               const Strips* strips) const {
+    Profiler::Scope scope(profiler_, Profiler::Backtrack, (long long)M.rows() * M.cols());
+    const int h = M.rows(), w = M.cols();
+    seam.resize(h);
+    if (strips) {
+        const int n = strips->count;
+        const std::size_t W = w;
+        seam[h - 1] = int(std::min_element(strips->total.begin(), strips->total.end())
+                          - strips->total.begin());
+        for (int s = n - 1; s >= 0; --s) {
+            const int first = int((long long)h * s / n), last = int((long long)h * (s + 1) / n);
+            for (int i = last - 1; i > first; --i) seam[i - 1] = cheapestAbove(M.row(i - 1), seam[i], w);
+            if (s > 0) seam[first - 1] = strips->link[s * W + seam[last - 1]];
         }
-        seam[i - 1] = best;
+        return;
+    }
+    const Cost* bottom = M.row(h - 1);
+    const Cost* first = bottom + (band ? band->first[h - 1] : 0);
+    const Cost* last = bottom + (band ? band->last[h - 1] : w);
+    seam[h - 1] = int(std::min_element(first, last) - bottom);
+    for (int i = h - 1; i > 0; --i) seam[i - 1] = cheapestAbove(M.row(i - 1), seam[i], w);
+}
+
+/**
+ * @brief Forward pass and backtrack of one seam.
+ */
+template <typename Energy, typename Cost>
+void SeamCarver::searchSeam(const Matrix<Energy>& energy, Matrix<Cost>& M, std::vector<int>& seam,
+                            const Band* band, Strips& strips) const {
+    strips.count = 0;
+    cumulativeCost(energy, M, band, &strips);
+    backtrackSeam(M, seam, band, strips.count ? &strips : nullptr);
+}
+
+/**
+ * @brief Whether seams over height rows of this image need 64-bit costs.
+ * @throws runtime_error if they do but Cost32 was requested.
+ */
+bool SeamCarver::wideCosts(int height) const {
+    return costTypeFor(costType_, height, image_.getMaxValue()) == Cost64;
+}
+
+/**
+ * @brief Find min-energy vertical seam 
+ */
+std::vector<int> SeamCarver::findVerticalSeam(const Matrix<int>& energy) const {
+    Strips strips;
+    std::vector<int> seam;
+    if (wideCosts(energy.rows())) {
+        Matrix<long long> M;
+        searchSeam(energy, M, seam, nullptr, strips);
+    } else {
+        Matrix<int> M;
+        searchSeam(energy, M, seam, nullptr, strips);
     }
     return seam;
 }
 
-SeamCarver::SeamCarver(const Image& img) : image_(img) {}
+SeamCarver::SeamCarver(const Image& img, ThreadPool* pool) : image_(img), pool_(pool) {}
+
+SeamCarver::SeamCarver(Image&& img, ThreadPool* pool) : image_(std::move(img)), pool_(pool) {}
+
+void SeamCarver::setProfiler(Profiler* profiler) { profiler_ = profiler; }
+
+void SeamCarver::recordSeams(History* history) { record_ = history; }
+
+void SeamCarver::setStrips(int strips, int overlap) {
+    strips_ = strips;
+    stripOverlap_ = std::max(0, overlap);
+}
+
+void SeamCarver::setCostType(CostType type) { costType_ = type; }
+
+void SeamCarver::setEnergyChannels(const std::vector<int>& channels) {
+    for (int c : channels)
+        if (c < 0 || c >= image_.getChannels()) throw std::runtime_error("Energy channel out of range");
+    energyChannels_ = channels;
+    grayValid_ = false;
+}
+
+void SeamCarver::setGrayPlane(bool enabled) {
+    grayPlane_ = enabled;
+    grayValid_ = false;
+}
+
+/**
+ * @brief Resolve AutoCost from the largest possible seam cost, height times
+ *        the largest energy of one pixel.
+ * @throws runtime_error if Cost32 is requested but too narrow.
+ */
+SeamCarver::CostType SeamCarver::costTypeFor(CostType type, long long height, int maxValue) {
+    if (type == Cost64) return Cost64;
+    const long long energy = kEnergyPerMaxValue * std::max(maxValue, 1);
+    // one extra row of headroom for cells outside a band
+    const bool fits = (height + 1) * energy <= outsideBand<int>();
+    if (fits) return Cost32;
+    if (type == Cost32)
+        throw std::runtime_error("Seam costs overflow 32 bits at this height and max value");
+    return Cost64;
+}
+
+bool SeamCarver::parseCostType(const std::string& name, CostType& type) {
+    if      (name == "auto") type = AutoCost;
+    else if (name == "32")   type = Cost32;
+    else if (name == "64")   type = Cost64;
+    else return false;
+    return true;
+}
+
+void SeamCarver::setGuide(const History* guide, int radius) {
+    guide_ = radius > 0 ? guide : nullptr;
+    guideRadius_ = radius;
+}
+
+/**
+ * @brief Build band_ around guide seam; false if it does not fit the image.
+ */
+bool SeamCarver::bandAround(const std::vector<int>& guide) {
+    const int h = image_.getHeight(), w = image_.getWidth();
+    if (int(guide.size()) != h) return false;
+    band_.first.resize(h);
+    band_.last.resize(h);
+    for (int i = 0; i < h; ++i) {
+        int c = std::min(std::max(guide[i], 0), w - 1);
+        band_.first[i] = std::max(0, c - guideRadius_);
+        band_.last[i] = std::min(w, c + guideRadius_ + 1);
+    }
+    return true;
+}
+
+/**
+ * @brief Find and remove one vertical seam of the current orientation.
+ */
+void SeamCarver::carveSeam(const std::vector<std::vector<int>>* guides,
+                           std::vector<std::vector<int>>* recorded, int index) {
+    Trace::Scope seamScope(profiler_ ? profiler_->trace() : nullptr, "seam");
+    const Band* band = guides && index < int(guides->size()) && bandAround((*guides)[index])
+                     ? &band_ : nullptr;
+    if (image_.isFloat()) {
+        computeEnergy(floatEnergy_, band);
+        searchSeam(floatEnergy_, floatCost_, seam_, band, stripData_);
+    } else {
+        if (!grayValid_ && useGrayPlane()) buildGray();
+        computeEnergy(energy_, band);
+        if (wideCosts(image_.getHeight())) searchSeam(energy_, wideCost_, seam_, band, stripData_);
+        else                               searchSeam(energy_, cost_, seam_, band, stripData_);
+    }
+    if (recorded) {
+        if (int(recorded->size()) <= index) recorded->resize(index + 1);
+        (*recorded)[index].assign(seam_.begin(), seam_.end());
+    }
+    Profiler::Scope scope(profiler_, Profiler::Remove,
+                          (long long)image_.getWidth() * image_.getHeight());
+    image_.removeSeam(seam_);
+    if (grayValid_) gray_.removeSeam(seam_);
+    if (profiler_) profiler_->addSeam();
+}
 
 /**
  * @brief Remove N vertical seams.
  */
 void SeamCarver::removeVerticalSeams(int count) {
     for (int k = 0; k < count; ++k) {
-        auto E = computeEnergy();
-        auto seam = findVerticalSeam(E);
-        image_.removeSeam(seam);
+        carveSeam(guide_ ? &guide_->vertical : nullptr, record_ ? &record_->vertical : nullptr,
+                  verticalDone_++);
     }
 }
 
@@ -81,12 +570,38 @@ void SeamCarver::removeVerticalSeams(int count) {
  */
 void SeamCarver::removeHorizontalSeams(int count) {
     for (int k = 0; k < count; ++k) {
-        image_.transpose();
-        removeVerticalSeams(1);
-        image_.transpose();
+        transposeImage();
+        carveSeam(guide_ ? &guide_->horizontal : nullptr, record_ ? &record_->horizontal : nullptr,
+                  horizontalDone_++);
+        transposeImage();
     }
 }
 
 /** @brief Get processed Image. */
 Image SeamCarver::getResult() const { return image_; }
 
+Image SeamCarver::takeResult() { return std::move(image_); }
+
+/**
+ * @brief Linear index in the original of every pixel that survives seams.
+ */
+Image SeamCarver::survivorMap(int width, int height, const History& seams) {
+    // indices are stored as samples
+    const long long pixels = (long long)width * height;
+    if (pixels > std::numeric_limits<int>::max())
+        throw std::runtime_error("Image too large for a survivor map");
+    Image map(width, height, 1, int(std::max(1LL, pixels - 1)));
+    for (int i = 0; i < height; ++i) {
+        int* row = map.rowData(i);
+        for (int j = 0; j < width; ++j) row[j] = i * width + j;
+    }
+    for (const auto& seam : seams.vertical) map.removeSeam(seam);
+    if (!seams.horizontal.empty()) {
+        // removing every horizontal seam in one transposed pass gives the same
+        // result as transposing around each of them
+        map.transpose();
+        for (const auto& seam : seams.horizontal) map.removeSeam(seam);
+        map.transpose();
+    }
+    return map;
+}
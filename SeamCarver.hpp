@@ -1,6 +1,11 @@
 #include <vector>
+#include <string>
+#include <cstdint>
 #include <cstdlib>
 #include "Image.hpp"
+#include "Matrix.hpp"
+#include "ThreadPool.hpp"
+#include "Profiler.hpp"
 
 #ifndef SEAMCARVER_HPP
 #define SEAMCARVER_HPP
@@ -10,21 +15,252 @@
  * @brief Performs seam carving on an Image.
  */
 class SeamCarver {
+public:
+    /**
+     * @struct History
+     * @brief Seams removed by a carver, in removal order. Each seam lists one
+     *        column per row in the coordinates of the image it was removed from;
+     *        horizontal seams are stored in the transposed orientation.
+     */
+    struct History {
+        std::vector<std::vector<int>> vertical, horizontal;
+    };
+
+    /**
+     * @brief Integer type of the cumulative seam costs. Costs grow by up to
+     *        four times the max value per row, so 32 bits overflow on tall
+     *        16-bit images; AutoCost uses 64 bits only for those.
+     */
+    enum CostType { AutoCost, Cost32, Cost64 };
+
 private:
     Image image_;
+    ThreadPool* pool_;
+    Profiler* profiler_ = nullptr;
+
+    // temporal warm start: seam k is searched within guideRadius_ of the guide's seam k
+    History* record_ = nullptr;
+    const History* guide_ = nullptr;
+    int guideRadius_ = 0;
+    int verticalDone_ = 0, horizontalDone_ = 0;
+
+    // approximate strip-parallel seam search; strips_ <= 1 is exact
+    int strips_ = 0, stripOverlap_ = 0;
+
+    CostType costType_ = AutoCost;
+
+    // channels whose mean is the gray value the energy is computed from; empty: all
+    std::vector<int> energyChannels_;
 
     /**
-     * @brief Compute energy map 
+     * @struct Strips
+     * @brief Per-strip results of the strip-parallel cost pass, each w
+     *        entries per strip: for every bottom-row column of a strip, the
+     *        column its path enters the strip at, the path's cost inside the
+     *        strip, and the bottom column of the strip above it continues from.
+     *        Costs are kept as doubles, exact for either integer cost type.
      */
-    std::vector<std::vector<int>> computeEnergy() const; 
+    struct Strips {
+        int count = 0;
+        std::vector<int> entry, link;
+        std::vector<double> inner;
+        std::vector<double> total; // full path cost per bottom column of the last strip
+    };
 
     /**
-     * @brief Find min-energy vertical seam 
+     * @struct Band
+     * @brief Columns [first[i], last[i]) searched in row i.
+     */
+    struct Band {
+        std::vector<int> first, last;
+    };
+
+    /**
+     * @brief Pixels a pass visits: the band's cells, or all width * height
+     *        without one. Keeps the per-pixel profiler figures honest in band mode.
+     */
+    static long long passPixels(const Band* band, int width, int height);
+
+    /**
+     * @brief Number of threads worth using for `work` independent items.
+     */
+    int threadsFor(int work) const;
+
+    // gray values as 16 bits, carved and transposed along with the image so
+    // the energy pass reads two bytes per pixel and skips the gray conversion
+    Matrix<std::uint16_t> gray_, grayScratch_;
+    bool grayValid_ = false;
+    bool grayPlane_ = true;
+
+    /** @brief Whether to keep gray_ for this image. */
+    bool useGrayPlane() const;
+
+    /** @brief Fill gray_ from the image. */
+    void buildGray();
+
+    /** @brief Transpose the image, and gray_ with it. */
+    void transposeImage();
+
+    // per-seam scratch, reused across iterations to avoid allocator churn
+    Matrix<int> energy_, cost_;
+    Matrix<long long> wideCost_;
+    Matrix<float> floatEnergy_, floatCost_;   // float images: float energies and costs
+    std::vector<int> seam_;
+    Band band_;
+    Strips stripData_;
+
+    /**
+     * @brief Gray values of n pixels at src, from energyChannels_.
+     */
+    void grayRow(const int* src, int* dst, int n) const;
+
+    /** @brief grayRow of a float image. */
+    void grayRow(const int* src, float* dst, int n) const;
+
+    /**
+     * @brief Compute energy map into E (resized to the image): int for
+     *        integer images, float for float ones. With a band, only the
+     *        band's columns are valid afterwards.
+     */
+    template <typename Energy>
+    void computeEnergy(Matrix<Energy>& E, const Band* band = nullptr) const;
+
+    /**
+     * @brief Forward DP pass: cumulative minimum cost per pixel into M.
+     *        With a band, cells outside it are never chosen.
+     */
+    template <typename Energy, typename Cost>
+    void cumulativeCost(const Matrix<Energy>& energy, Matrix<Cost>& M, const Band* band = nullptr,
+                        Strips* strips = nullptr) const;
+
+    /**
+     * @brief Strip-parallel variant of the forward pass, see setStrips().
+     */
+    template <typename Energy, typename Cost>
+    void stripCost(const Matrix<Energy>& energy, Matrix<Cost>& M, Strips& strips) const;
+
+    /**
+     * @brief Trace the cheapest seam back from the bottom row of a cost matrix,
+     *        crossing strip boundaries through strips->link if given.
+     */
+    template <typename Cost>
+    void backtrackSeam(const Matrix<Cost>& M, std::vector<int>& seam, const Band* band = nullptr,
+                       const Strips* strips = nullptr) const;
+
+    /**
+     * @brief Forward pass and backtrack of one seam over energy, with costs in M.
+     */
+    template <typename Energy, typename Cost>
+    void searchSeam(const Matrix<Energy>& energy, Matrix<Cost>& M, std::vector<int>& seam,
+                    const Band* band, Strips& strips) const;
+
+    /** @brief Whether seams over the current orientation need 64-bit costs. */
+    bool wideCosts(int height) const;
+
+    /**
+     * @brief Build band_ around guide seam; false if it does not fit the image.
      */
-    std::vector<int> findVerticalSeam(const std::vector<std::vector<int>>& energy) const; 
+    bool bandAround(const std::vector<int>& guide);
+
+    /**
+     * @brief Find and remove one vertical seam of the current orientation.
+     * @param guides Seams of the previous frame for this orientation, or nullptr.
+     * @param recorded Where to store the seam, or nullptr.
+     * @param index Index of this seam within its orientation.
+     */
+    void carveSeam(const std::vector<std::vector<int>>* guides,
+                   std::vector<std::vector<int>>* recorded, int index);
 
 public:
-    explicit SeamCarver(const Image& img);
+    /**
+     * @brief Create a carver for img.
+     * @param pool Optional thread pool for the energy and seam search passes;
+     *             nullptr runs single-threaded. Not owned.
+     */
+    explicit SeamCarver(const Image& img, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Create a carver that takes over img's pixels instead of copying
+     *        them, so only one copy of the image is alive while carving.
+     */
+    explicit SeamCarver(Image&& img, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Record per-phase timings into profiler (nullptr disables). Not owned.
+     */
+    void setProfiler(Profiler* profiler);
+
+    /**
+     * @brief Store every removed seam into history (nullptr disables). Entries
+     *        are overwritten in place, so reusing a history across frames of the
+     *        same size does not allocate. Not owned.
+     */
+    void recordSeams(History* history);
+
+    /**
+     * @brief Trade exactness for parallelism in the seam search: split the
+     *        rows into strips whose cost passes run concurrently on the pool.
+     *        Each strip starts overlap rows early so its paths see some of
+     *        the image above; a small DP over the strip boundaries then joins
+     *        the per-strip paths into the cheapest connected seam among them.
+     *        Seams may cost slightly more than the optimum. strips <= 1 (the
+     *        default) keeps the exact row-synchronized search.
+     */
+    void setStrips(int strips, int overlap);
+
+    /**
+     * @brief Choose the cost type (default AutoCost). Cost32 is checked: carving
+     *        throws if the image is tall enough to overflow it. Float images
+     *        always use float costs.
+     */
+    void setCostType(CostType type);
+
+    /**
+     * @brief Compute the energy from the mean of these channels only, e.g.
+     *        the color channels of an RGBA image; empty (the default) uses all.
+     *        Seams always remove every channel.
+     * @throws runtime_error on a channel the image does not have.
+     */
+    void setEnergyChannels(const std::vector<int>& channels);
+
+    /**
+     * @brief Keep the 16-bit gray plane for multi-channel images (default on);
+     *        off converts their rows to gray on every seam. Output is the same
+     *        either way; for benchmarks and tests.
+     */
+    void setGrayPlane(bool enabled);
+
+    /**
+     * @brief Cost type that carving height rows of samples up to maxValue uses
+     *        when type is requested.
+     * @throws runtime_error if type is Cost32 and costs could overflow it.
+     */
+    static CostType costTypeFor(CostType type, long long height, int maxValue);
+
+    /**
+     * @brief Parse "auto", "32" or "64".
+     * @return false for anything else.
+     */
+    static bool parseCostType(const std::string& name, CostType& type);
+
+    /**
+     * @brief Search seam k only within radius columns of seam k of guide,
+     *        typically the history of the previous video frame. Seams without
+     *        a fitting guide are searched over the full width; radius 0 or a
+     *        null guide disables the restriction. Not owned.
+     */
+    void setGuide(const History* guide, int radius);
+
+    /**
+     * @brief Compute energy map 
+     * @throws runtime_error for a float image.
+     */
+    Matrix<int> computeEnergy() const; 
+
+    /**
+     * @brief Find min-energy vertical seam 
+     */
+    std::vector<int> findVerticalSeam(const Matrix<int>& energy) const; 
 
     /**
      * @brief Remove N vertical seams.
@@ -38,6 +274,16 @@ public:
 
     /** @brief Get processed Image. */
     Image getResult() const; 
+
+    /** @brief Move the processed image out without a copy; the carver is spent. */
+    Image takeResult();
+
+    /**
+     * @brief For every pixel of an image carved with seams, its linear index
+     *        (row * width + column) in the width x height original. Used to
+     *        carry luma seams over to other planes.
+     */
+    static Image survivorMap(int width, int height, const History& seams);
 };
 
 #endif // !SEAMCARVER_HPP
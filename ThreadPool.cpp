@@ -0,0 +1,138 @@
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include "ThreadPool.hpp"
+
+namespace {
+
+// thread-local so that barrier() can charge the waiting thread
+thread_local long long tlsBarrierNs = 0;
+
+long long nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < threads; ++i)
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+int ThreadPool::size() const { return int(workers_.size()) + 1; }
+
+/**
+ * @brief Execute the current job as participant index and record its timing.
+ */
+void ThreadPool::participate(int index) {
+    tlsBarrierNs = 0;
+    long long start = nowNs();
+    {
+        Trace::Scope scope(trace_, "region");
+        (*job_)(index, jobThreads_);
+    }
+    long long total = nowNs() - start;
+    computeNs_ += total - tlsBarrierNs;
+    barrierNs_ += tlsBarrierNs;
+}
+
+void ThreadPool::workerLoop(int index) {
+    long long seen = 0;
+    bool named = false;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            if (index >= jobThreads_) continue;
+        }
+        if (trace_ && !named) {
+            trace_->setThreadName("pool worker " + std::to_string(index));
+            named = true;
+        }
+        participate(index);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) done_.notify_one();
+        }
+    }
+}
+
+/**
+ * @brief Run fn on up to `threads` threads, the caller being index 0.
+ */
+void ThreadPool::run(int threads, const std::function<void(int, int)>& fn) {
+    threads = std::clamp(threads, 1, size());
+    ++regions_;
+    if (threads == 1) {
+        job_ = &fn;
+        jobThreads_ = 1;
+        participate(0);
+        job_ = nullptr;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        jobThreads_ = threads;
+        pending_ = threads - 1;
+        arrived_ = 0;
+        ++generation_;
+    }
+    wake_.notify_all();
+    participate(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return pending_ == 0; });
+    job_ = nullptr;
+}
+
+/**
+ * @brief Sense-reversing barrier over the participants of the current region.
+ *        Spins briefly, then yields, since waits between DP rows are short.
+ */
+void ThreadPool::barrier() {
+    if (jobThreads_ <= 1) return;
+    long long start = nowNs();
+    long long gen = barrierGeneration_.load(std::memory_order_acquire);
+    if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == jobThreads_) {
+        arrived_.store(0, std::memory_order_relaxed);
+        barrierGeneration_.fetch_add(1, std::memory_order_release);
+    } else {
+        int spins = 0;
+        while (barrierGeneration_.load(std::memory_order_acquire) == gen) {
+            if (++spins > 1024) std::this_thread::yield();
+        }
+    }
+    tlsBarrierNs += nowNs() - start;
+}
+
+void ThreadPool::setTrace(Trace* trace) { trace_ = trace; }
+
+ThreadPool::Stats ThreadPool::stats() const {
+    Stats s;
+    s.computeSeconds = computeNs_.load() * 1e-9;
+    s.barrierSeconds = barrierNs_.load() * 1e-9;
+    s.regions = regions_.load();
+    return s;
+}
+
+void ThreadPool::resetStats() {
+    computeNs_ = 0;
+    barrierNs_ = 0;
+    regions_ = 0;
+}
@@ -0,0 +1,90 @@
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include "Trace.hpp"
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads executing fork-join parallel regions.
+ *
+ * A region runs the same function on several threads; the calling thread
+ * takes part as index 0. Inside a region, barrier() synchronizes all of its
+ * participants, which is what the row-by-row seam search needs.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Time accumulated over all participants of all regions.
+     */
+    struct Stats {
+        double computeSeconds = 0; // time in regions outside of barriers
+        double barrierSeconds = 0; // time waiting in barrier()
+        long long regions = 0;     // number of regions run
+    };
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    const std::function<void(int, int)>* job_ = nullptr;
+    int jobThreads_ = 0;
+    long long generation_ = 0;
+    int pending_ = 0;
+    bool stop_ = false;
+
+    // barrier state
+    std::atomic<int> arrived_{0};
+    std::atomic<long long> barrierGeneration_{0};
+
+    std::atomic<long long> computeNs_{0}, barrierNs_{0}, regions_{0};
+    Trace* trace_ = nullptr;
+
+    void workerLoop(int index);
+    void participate(int index);
+
+public:
+    /**
+     * @brief Create a pool.
+     * @param threads Total threads per region including the caller; 0 uses
+     *                std::thread::hardware_concurrency().
+     */
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** @brief Number of threads available to a region (workers + caller). */
+    int size() const;
+
+    /**
+     * @brief Run fn(index, count) on count = min(threads, size()) threads and wait.
+     *        Must not be called from inside a region.
+     */
+    void run(int threads, const std::function<void(int index, int count)>& fn);
+
+    /**
+     * @brief Wait until every participant of the current region has arrived.
+     */
+    void barrier();
+
+    /**
+     * @brief Emit a "region" trace event per participant of every region
+     *        (nullptr disables). Not owned; set while no region is running.
+     */
+    void setTrace(Trace* trace);
+
+    /** @brief Accumulated timing since construction or the last resetStats(). */
+    Stats stats() const;
+
+    /** @brief Clear accumulated timing. */
+    void resetStats();
+};
+
+#endif // !THREADPOOL_HPP
@@ -0,0 +1,87 @@
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include "Trace.hpp"
+
+namespace {
+
+// Track ids are process-wide so that several Trace objects agree on them.
+std::atomic<int> nextThreadId{0};
+thread_local int tlsThreadId = -1;
+
+} // namespace
+
+Trace::Scope::Scope(Trace* trace, const char* name) : trace_(trace), name_(name) {
+    if (trace_) trace_->begin(name_);
+}
+
+Trace::Scope::~Scope() {
+    if (trace_) trace_->end(name_);
+}
+
+Trace::Trace() : start_(std::chrono::steady_clock::now()) {}
+
+int Trace::threadId() {
+    if (tlsThreadId < 0) tlsThreadId = nextThreadId++;
+    return tlsThreadId;
+}
+
+void Trace::begin(const char* name) {
+    double ts = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_).count();
+    int tid = threadId();
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back({ name, 'B', tid, ts });
+}
+
+void Trace::end(const char* name) {
+    double ts = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_).count();
+    int tid = threadId();
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back({ name, 'E', tid, ts });
+}
+
+void Trace::setThreadName(const std::string& name) {
+    int tid = threadId();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (threadNames_.size() <= std::size_t(tid)) threadNames_.resize(tid + 1);
+    if (threadNames_[tid].empty()) threadNames_[tid] = name;
+}
+
+/**
+ * @brief Write all events plus thread_name metadata in Chrome trace JSON.
+ */
+void Trace::write(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+    for (std::size_t tid = 0; tid < threadNames_.size(); ++tid) {
+        if (threadNames_[tid].empty()) continue;
+        // names are set by our own code and contain no characters needing escapes
+        out << (first ? "\n" : ",\n")
+            << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << tid
+            << ", \"args\": {\"name\": \"" << threadNames_[tid] << "\"}}";
+        first = false;
+    }
+    for (const Event& e : events_) {
+        out << (first ? "\n" : ",\n")
+            << "{\"name\": \"" << e.name << "\", \"ph\": \"" << e.phase
+            << "\", \"pid\": 1, \"tid\": " << e.tid << ", \"ts\": " << e.ts << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void Trace::write(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out) throw std::runtime_error("Cannot open trace file");
+    write(out);
+}
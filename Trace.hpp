@@ -0,0 +1,74 @@
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <iosfwd>
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+/**
+ * @class Trace
+ * @brief Collects begin/end events and writes them in Chrome trace format
+ *        (loadable in chrome://tracing and Perfetto).
+ *
+ * Thread safe: every thread gets its own track, numbered in order of first use.
+ */
+class Trace {
+public:
+    /**
+     * @class Scope
+     * @brief Emits a begin event now and the matching end event on destruction.
+     *        A null Trace makes it a no-op.
+     */
+    class Scope {
+    private:
+        Trace* trace_;
+        const char* name_;
+
+    public:
+        Scope(Trace* trace, const char* name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    struct Event {
+        const char* name; // static string
+        char phase;       // 'B' or 'E'
+        int tid;
+        double ts;        // microseconds since construction
+    };
+
+    std::chrono::steady_clock::time_point start_;
+    mutable std::mutex mutex_;
+    std::vector<Event> events_;
+    std::vector<std::string> threadNames_;
+
+    int threadId();
+
+public:
+    Trace();
+
+    /** @brief Record the start of a section on the calling thread. */
+    void begin(const char* name);
+
+    /** @brief Record the end of the innermost open section on the calling thread. */
+    void end(const char* name);
+
+    /** @brief Label the calling thread's track; the first label given wins. */
+    void setThreadName(const std::string& name);
+
+    /** @brief Write {"traceEvents": [...]} JSON. */
+    void write(std::ostream& out) const;
+
+    /**
+     * @brief Write the trace to a file.
+     * @throws runtime_error on I/O error.
+     */
+    void write(const std::string& filename) const;
+};
+
+#endif // !TRACE_HPP
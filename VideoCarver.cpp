@@ -0,0 +1,71 @@
+#include <string>
+#include <utility>
+#include <stdexcept>
+#include "VideoCarver.hpp"
+
+VideoCarver::VideoCarver(int vertical, int horizontal, ThreadPool* pool)
+    : vertical_(vertical), horizontal_(horizontal), pool_(pool) {}
+
+void VideoCarver::setBand(int radius) { band_ = radius; }
+
+void VideoCarver::setKeyframeInterval(int frames) { keyframeInterval_ = frames; }
+
+void VideoCarver::setSceneCutThreshold(double threshold) { cuts_ = SceneCutDetector(threshold); }
+
+void VideoCarver::setProfiler(Profiler* profiler) { profiler_ = profiler; }
+
+/**
+ * @brief Forget the previous frame, e.g. at a scene cut.
+ */
+void VideoCarver::reset() {
+    warm_ = false;
+    cuts_.reset();
+}
+
+/**
+ * @brief Carve the next frame, guided by the seams of the previous one.
+ * @throws runtime_error if the frame is too small for the seam counts.
+ */
+Image VideoCarver::carve(Image frame) {
+    if (vertical_ >= frame.getWidth() || horizontal_ >= frame.getHeight()) {
+        throw std::runtime_error("Frame " + std::to_string(frames_) + " is "
+                                 + std::to_string(frame.getWidth()) + "x"
+                                 + std::to_string(frame.getHeight())
+                                 + ", too small for the requested seams");
+    }
+    if (frame.getWidth() != width_ || frame.getHeight() != height_
+        || frame.getChannels() != channels_) {
+        width_ = frame.getWidth();
+        height_ = frame.getHeight();
+        channels_ = frame.getChannels();
+        warm_ = false;
+    }
+    if (keyframeInterval_ > 0 && sinceKeyframe_ >= keyframeInterval_) warm_ = false;
+    if (cuts_.isCut(frame)) {
+        ++sceneCuts_;
+        warm_ = false;
+    }
+    if (!warm_) sinceKeyframe_ = 0;
+
+    SeamCarver sc(std::move(frame), pool_);
+    sc.setProfiler(profiler_);
+    sc.recordSeams(&current_);
+    if (warm_) sc.setGuide(&previous_, band_);
+    sc.removeVerticalSeams(vertical_);
+    sc.removeHorizontalSeams(horizontal_);
+
+    std::swap(previous_, current_);
+    warm_ = true;
+    ++sinceKeyframe_;
+    ++frames_;
+    return sc.takeResult();
+}
+
+/** @brief Seams removed from the last carved frame. */
+const SeamCarver::History& VideoCarver::seams() const { return previous_; }
+
+/** @brief Number of frames carved so far. */
+long long VideoCarver::frames() const { return frames_; }
+
+/** @brief Number of scene cuts detected so far. */
+long long VideoCarver::sceneCuts() const { return sceneCuts_; }
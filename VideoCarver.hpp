@@ -0,0 +1,90 @@
+#include "Image.hpp"
+#include "SeamCarver.hpp"
+#include "ThreadPool.hpp"
+#include "Profiler.hpp"
+#include "SceneCut.hpp"
+
+#ifndef VIDEOCARVER_HPP
+#define VIDEOCARVER_HPP
+
+/**
+ * @class VideoCarver
+ * @brief Carves consecutive frames of a video to the same output size.
+ *
+ * Each seam of a frame is searched only within a band around the matching
+ * seam of the previous frame. Seams then move smoothly from frame to frame
+ * instead of jumping between unrelated paths, and the energy and DP passes
+ * touch only the band instead of the whole frame. At a scene cut the
+ * previous seams are dropped and the frame is searched in full.
+ */
+class VideoCarver {
+private:
+    int vertical_, horizontal_;
+    ThreadPool* pool_;
+    Profiler* profiler_ = nullptr;
+    int band_ = 8;
+    int keyframeInterval_ = 0;
+
+    SceneCutDetector cuts_;
+    long long frames_ = 0, sceneCuts_ = 0;
+    long long sinceKeyframe_ = 0;
+    int width_ = 0, height_ = 0, channels_ = 0;
+    bool warm_ = false;                       // previous_ holds seams of a matching frame
+    SeamCarver::History previous_, current_;
+
+public:
+    /**
+     * @brief Carve every frame by the given number of seams.
+     * @param pool Optional thread pool for full-width searches. Not owned.
+     */
+    VideoCarver(int vertical, int horizontal, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Search radius around the previous frame's seams (default 8);
+     *        0 searches every frame over the full width.
+     */
+    void setBand(int radius);
+
+    /**
+     * @brief Search the full width every n frames (0, the default: only on
+     *        the first frame and after a size change).
+     */
+    void setKeyframeInterval(int frames);
+
+    /**
+     * @brief Histogram difference that counts as a scene cut (see
+     *        SceneCutDetector); 0 disables detection.
+     */
+    void setSceneCutThreshold(double threshold);
+
+    /**
+     * @brief Record per-phase timings into profiler (nullptr disables). Not owned.
+     */
+    void setProfiler(Profiler* profiler);
+
+    /**
+     * @brief Forget the previous frame, e.g. at a scene cut.
+     */
+    void reset();
+
+    /**
+     * @brief Carve the next frame. Taken by value: pass an rvalue to carve it
+     *        in place without a copy.
+     * @throws runtime_error if the frame is too small for the seam counts.
+     */
+    Image carve(Image frame);
+
+    /**
+     * @brief Seams removed from the last carved frame, e.g. to build a
+     *        SeamCarver::survivorMap for its other planes.
+     */
+    const SeamCarver::History& seams() const;
+
+    /** @brief Number of frames carved so far. */
+    long long frames() const;
+
+    /** @brief Number of scene cuts detected so far. */
+    long long sceneCuts() const;
+};
+
+#endif // !VIDEOCARVER_HPP
@@ -0,0 +1,245 @@
+#include <vector>
+#include <string>
+#include <sstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <cstdlib>
+#include "Y4M.hpp"
+#include "SeamCarver.hpp"
+
+namespace {
+
+const char kSignature[] = "YUV4MPEG2";
+
+/**
+ * @brief Read one '\n' terminated header line; false at a clean end of stream.
+ */
+bool readLine(std::istream& in, std::string& line) {
+    line.clear();
+    int c;
+    while ((c = in.get()) != std::char_traits<char>::eof() && c != '\n') {
+        line.push_back(char(c));
+        if (line.size() > 4096) throw std::runtime_error("Y4M header line too long");
+    }
+    if (c == std::char_traits<char>::eof() && line.empty()) return false;
+    if (c != '\n') throw std::runtime_error("Truncated Y4M header");
+    return true;
+}
+
+/**
+ * @brief Bit depth suffix of a colour space ("p10" or "10"), 8 if absent.
+ */
+int parseBits(const std::string& suffix, const std::string& colorspace) {
+    std::string digits = !suffix.empty() && suffix[0] == 'p' ? suffix.substr(1) : suffix;
+    if (digits.empty()) return 8;
+    char* end = nullptr;
+    long bits = std::strtol(digits.c_str(), &end, 10);
+    if (*end != '\0' || bits < 8 || bits > 16)
+        throw std::runtime_error("Unsupported Y4M colour space: " + colorspace);
+    return int(bits);
+}
+
+} // namespace
+
+/**
+ * @brief Parse the header tags after the signature.
+ * @throws runtime_error on missing size or unsupported colour space.
+ */
+Y4MHeader Y4MHeader::parse(const std::string& line) {
+    Y4MHeader h;
+    std::istringstream tokens(line);
+    std::string tag;
+    while (tokens >> tag) {
+        const std::string value = tag.substr(1);
+        if (tag[0] == 'W') {
+            h.width = std::atoi(value.c_str());
+        } else if (tag[0] == 'H') {
+            h.height = std::atoi(value.c_str());
+        } else {
+            if (tag[0] == 'C') {
+                auto starts = [&](const std::string& prefix) { return value.compare(0, prefix.size(), prefix) == 0; };
+                if (value == "444alpha") {
+                    h.planes = 4; h.subX = 1; h.subY = 1;
+                } else if (value == "420jpeg" || value == "420paldv" || value == "420mpeg2") {
+                    h.subX = 2; h.subY = 2;
+                } else if (starts("420")) {
+                    h.subX = 2; h.subY = 2; h.bits = parseBits(value.substr(3), value);
+                } else if (starts("422")) {
+                    h.subX = 2; h.subY = 1; h.bits = parseBits(value.substr(3), value);
+                } else if (starts("444")) {
+                    h.subX = 1; h.subY = 1; h.bits = parseBits(value.substr(3), value);
+                } else if (starts("411")) {
+                    h.subX = 4; h.subY = 1; h.bits = parseBits(value.substr(3), value);
+                } else if (starts("mono")) {
+                    h.planes = 1; h.bits = parseBits(value.substr(4), value);
+                } else {
+                    throw std::runtime_error("Unsupported Y4M colour space: " + value);
+                }
+            }
+            h.tags.push_back(tag);
+        }
+    }
+    if (h.width <= 0 || h.height <= 0) throw std::runtime_error("Y4M header without frame size");
+    return h;
+}
+
+/** @brief Header line including signature, without the newline. */
+std::string Y4MHeader::str() const {
+    std::string line = std::string(kSignature) + " W" + std::to_string(width)
+                     + " H" + std::to_string(height);
+    for (const auto& t : tags) line += " " + t;
+    return line;
+}
+
+int Y4MHeader::planeWidth(int p) const {
+    return p == 0 || p == 3 ? width : (width + subX - 1) / subX;
+}
+
+int Y4MHeader::planeHeight(int p) const {
+    return p == 0 || p == 3 ? height : (height + subY - 1) / subY;
+}
+
+long long Y4MHeader::frameBytes() const {
+    long long samples = 0;
+    for (int p = 0; p < planes; ++p) samples += (long long)planeWidth(p) * planeHeight(p);
+    return samples * (bits > 8 ? 2 : 1);
+}
+
+/**
+ * @brief Read the stream header.
+ * @throws runtime_error if the stream is not YUV4MPEG2.
+ */
+Y4MReader::Y4MReader(std::istream& in) : in_(in) {
+    std::string line;
+    if (!readLine(in_, line) || line.compare(0, sizeof(kSignature) - 1, kSignature) != 0)
+        throw std::runtime_error("Invalid magic (expected YUV4MPEG2)");
+    header_ = Y4MHeader::parse(line.substr(sizeof(kSignature) - 1));
+}
+
+Y4MReader::Y4MReader(std::istream& in, const Y4MHeader& header) : in_(in), header_(header) {}
+
+const Y4MHeader& Y4MReader::header() const { return header_; }
+
+/**
+ * @brief Step over the next frame without decoding it.
+ * @return false at the end of the stream.
+ */
+bool Y4MReader::skip() {
+    std::string line;
+    if (!readLine(in_, line)) return false;
+    if (line.compare(0, 5, "FRAME") != 0) throw std::runtime_error("Y4M frame header expected");
+    // check that the last sample exists before stepping past it
+    if (!in_.seekg(header_.frameBytes() - 1, std::ios::cur)
+        || in_.peek() == std::char_traits<char>::eof())
+        throw std::runtime_error("Truncated Y4M frame");
+    in_.seekg(1, std::ios::cur);
+    return true;
+}
+
+/**
+ * @brief Read the next frame into one gray Image per plane.
+ * @return false at the end of the stream.
+ * @throws runtime_error on a truncated or malformed frame, or a sample
+ *         above the header's bit depth.
+ */
+bool Y4MReader::next(std::vector<Image>& planes) {
+    std::string line;
+    if (!readLine(in_, line)) return false;
+    if (line.compare(0, 5, "FRAME") != 0) throw std::runtime_error("Y4M frame header expected");
+    const int bytes = header_.bits > 8 ? 2 : 1;
+    const int maxValue = (1 << header_.bits) - 1;
+    planes.clear();
+    for (int p = 0; p < header_.planes; ++p) {
+        const int w = header_.planeWidth(p), h = header_.planeHeight(p);
+        buffer_.resize(std::size_t(w) * bytes);
+        Image plane(w, h, 1, maxValue);
+        for (int i = 0; i < h; ++i) {
+            if (!in_.read(reinterpret_cast<char*>(buffer_.data()), buffer_.size()))
+                throw std::runtime_error("Truncated Y4M frame");
+            int* row = plane.rowData(i);
+            if (bytes == 1) {
+                for (int j = 0; j < w; ++j) row[j] = buffer_[j];
+            } else {
+                // p10 and p12 leave high bits that must be zero; the carver's
+                // cost bounds trust maxValue
+                int high = 0;
+                for (int j = 0; j < w; ++j) {
+                    row[j] = buffer_[2 * j] | buffer_[2 * j + 1] << 8;
+                    high |= row[j] & ~maxValue;
+                }
+                if (high) throw std::runtime_error("Y4M sample above max value");
+            }
+        }
+        planes.push_back(std::move(plane));
+    }
+    return true;
+}
+
+/**
+ * @brief Write the stream header unless continuing an existing stream.
+ */
+Y4MWriter::Y4MWriter(std::ostream& out, const Y4MHeader& header, bool writeHeader)
+    : out_(out), header_(header) {
+    if (writeHeader) out_ << header_.str() << '\n';
+}
+
+/**
+ * @brief Write one frame; planes must match the header.
+ * @throws runtime_error on size mismatch or I/O error.
+ */
+void Y4MWriter::write(const std::vector<Image>& planes) {
+    if (int(planes.size()) != header_.planes) throw std::runtime_error("Y4M plane count mismatch");
+    const int bytes = header_.bits > 8 ? 2 : 1;
+    out_ << "FRAME\n";
+    for (int p = 0; p < header_.planes; ++p) {
+        const int w = header_.planeWidth(p), h = header_.planeHeight(p);
+        if (planes[p].getWidth() != w || planes[p].getHeight() != h)
+            throw std::runtime_error("Y4M plane size mismatch");
+        buffer_.resize(std::size_t(w) * bytes);
+        for (int i = 0; i < h; ++i) {
+            const int* row = planes[p].rowData(i);
+            if (bytes == 1) {
+                for (int j = 0; j < w; ++j) buffer_[j] = (unsigned char)row[j];
+            } else {
+                for (int j = 0; j < w; ++j) {
+                    buffer_[2 * j] = (unsigned char)(row[j] & 0xff);
+                    buffer_[2 * j + 1] = (unsigned char)(row[j] >> 8);
+                }
+            }
+            out_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+        }
+    }
+    if (!out_) throw std::runtime_error("Cannot write Y4M frame");
+}
+
+/**
+ * @brief Carve the luma plane and carry its seams over to the other planes.
+ */
+std::vector<Image> carveY4MFrame(VideoCarver& carver, const Y4MHeader& header,
+                                 std::vector<Image> planes) {
+    std::vector<Image> out;
+    out.push_back(carver.carve(std::move(planes[0])));
+    if (planes.size() == 1) return out;
+
+    const int outW = out[0].getWidth(), outH = out[0].getHeight();
+    const Image map = SeamCarver::survivorMap(header.width, header.height, carver.seams());
+    for (std::size_t p = 1; p < planes.size(); ++p) {
+        const Image& src = planes[p];
+        const int sx = p == 3 ? 1 : header.subX, sy = p == 3 ? 1 : header.subY;
+        const int w = (outW + sx - 1) / sx, h = (outH + sy - 1) / sy;
+        Image dst(w, h, 1, src.getMaxValue());
+        for (int i = 0; i < h; ++i) {
+            // the luma sample at the top left of each subsampled block decides
+            const int* survivors = map.rowData(i * sy);
+            int* row = dst.rowData(i);
+            for (int j = 0; j < w; ++j) {
+                const int index = survivors[j * sx];
+                row[j] = src.rowData(index / header.width / sy)[index % header.width / sx];
+            }
+        }
+        out.push_back(std::move(dst));
+    }
+    return out;
+}
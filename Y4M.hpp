@@ -0,0 +1,121 @@
+#include <vector>
+#include <string>
+#include <iosfwd>
+#include "Image.hpp"
+#include "VideoCarver.hpp"
+
+#ifndef Y4M_HPP
+#define Y4M_HPP
+
+/**
+ * @struct Y4MHeader
+ * @brief Stream header of a YUV4MPEG2 file.
+ *
+ * Frames hold a luma plane followed by chroma planes subsampled by
+ * (subX, subY), and for 444alpha a full size alpha plane. Samples are one
+ * byte, or two bytes little endian for more than 8 bits.
+ */
+struct Y4MHeader {
+    int width = 0, height = 0;
+    int planes = 3;                 // 1 for mono, 4 for 444alpha
+    int subX = 2, subY = 2;         // chroma subsampling
+    int bits = 8;
+    std::vector<std::string> tags;  // every other tag (F, I, A, C, X), kept verbatim
+
+    /**
+     * @brief Parse the header line without its "YUV4MPEG2" signature.
+     * @throws runtime_error on missing size or unsupported colour space.
+     */
+    static Y4MHeader parse(const std::string& line);
+
+    /** @brief Header line including signature, without the newline. */
+    std::string str() const;
+
+    /** @brief Width of plane p. */
+    int planeWidth(int p) const;
+
+    /** @brief Height of plane p. */
+    int planeHeight(int p) const;
+
+    /** @brief Bytes of sample data per frame, without the FRAME line. */
+    long long frameBytes() const;
+};
+
+/**
+ * @class Y4MReader
+ * @brief Reads YUV4MPEG2 frames one at a time from a stream.
+ */
+class Y4MReader {
+private:
+    std::istream& in_;
+    Y4MHeader header_;
+    std::vector<unsigned char> buffer_;
+
+public:
+    /**
+     * @brief Read the stream header.
+     * @throws runtime_error if the stream is not YUV4MPEG2.
+     */
+    explicit Y4MReader(std::istream& in);
+
+    /**
+     * @brief Continue reading a stream that is positioned at a FRAME line,
+     *        e.g. after seeking to an offset found by skip().
+     */
+    Y4MReader(std::istream& in, const Y4MHeader& header);
+
+    const Y4MHeader& header() const;
+
+    /**
+     * @brief Step over the next frame without decoding it (seeks past the samples).
+     * @return false at the end of the stream.
+     * @throws runtime_error on a malformed frame header.
+     */
+    bool skip();
+
+    /**
+     * @brief Read the next frame into one gray Image per plane.
+     * @return false at the end of the stream.
+     * @throws runtime_error on a truncated or malformed frame, or a sample
+     *         above the header's bit depth.
+     */
+    bool next(std::vector<Image>& planes);
+};
+
+/**
+ * @class Y4MWriter
+ * @brief Writes YUV4MPEG2 frames to a stream.
+ */
+class Y4MWriter {
+private:
+    std::ostream& out_;
+    Y4MHeader header_;
+    std::vector<unsigned char> buffer_;
+
+public:
+    /**
+     * @brief Write the stream header, unless writeHeader is false because out
+     *        is positioned at a frame of an existing stream.
+     */
+    Y4MWriter(std::ostream& out, const Y4MHeader& header, bool writeHeader = true);
+
+    /**
+     * @brief Write one frame; planes must match the header.
+     * @throws runtime_error on size mismatch or I/O error.
+     */
+    void write(const std::vector<Image>& planes);
+};
+
+/**
+ * @brief Carve the luma plane of a frame with carver and carry its seams
+ *        over to the other planes.
+ *
+ * Each output sample of a subsampled plane takes the chroma of the luma
+ * pixel it sits on, looked up through the survivor map of the luma seams;
+ * full size planes lose exactly the luma seams. The luma plane is carved
+ * in place, so move planes in where the frame is not needed afterwards.
+ */
+std::vector<Image> carveY4MFrame(VideoCarver& carver, const Y4MHeader& header,
+                                 std::vector<Image> planes);
+
+#endif // !Y4M_HPP
@@ -0,0 +1,14 @@
+#ifndef BENCH_BENCH_HPP
+#define BENCH_BENCH_HPP
+
+/**
+ * @brief Subcommands of the benchmark driver. Each receives the arguments
+ *        following the subcommand name and returns the process exit code.
+ */
+int runCarve(int argc, char* argv[]);
+int runMicro(int argc, char* argv[]);
+int runCorpus(int argc, char* argv[]);
+int runGenerate(int argc, char* argv[]);
+int runScaling(int argc, char* argv[]);
+
+#endif // !BENCH_BENCH_HPP
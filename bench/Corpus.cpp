@@ -0,0 +1,246 @@
+/**
+ * @file Corpus.cpp
+ * @brief End-to-end benchmark over a directory of images with baseline comparison.
+ *
+ * Every image in the corpus is loaded, carved with each seam recipe and written
+ * back to disk. The median time of each phase over the repetitions is stored
+ * as JSON; if a baseline file is given, entries whose total time grew by more
+ * than the threshold are reported and the run fails.
+ */
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <cstdlib>
+#include <cmath>
+#include "Image.hpp"
+#include "SeamCarver.hpp"
+#include "Json.hpp"
+#include "Bench.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * @struct Recipe
+ * @brief Seam counts to remove; negative values are percentages of the dimension.
+ */
+struct Recipe {
+    std::string label;
+    int vertical = 0, horizontal = 0;
+
+    static int resolve(int value, int dim) {
+        return value >= 0 ? value : (-value * dim) / 100;
+    }
+};
+
+struct Entry {
+    std::string image, recipe;
+    int width = 0, height = 0, seamsV = 0, seamsH = 0;
+    double loadMs = 0, carveMs = 0, writeMs = 0, totalMs = 0;
+};
+
+int parseCount(const std::string& s) {
+    if (!s.empty() && s.back() == '%') return -std::atoi(s.c_str());
+    return std::atoi(s.c_str());
+}
+
+/**
+ * @brief Parse "V:H[,V:H...]" where V and H are counts or percentages ("10%").
+ */
+std::vector<Recipe> parseRecipes(const std::string& arg) {
+    std::vector<Recipe> recipes;
+    std::size_t start = 0;
+    while (start <= arg.size()) {
+        std::size_t end = arg.find(',', start);
+        if (end == std::string::npos) end = arg.size();
+        std::string item = arg.substr(start, end - start);
+        auto colon = item.find(':');
+        if (colon == std::string::npos) throw std::runtime_error("Invalid recipe: " + item);
+        recipes.push_back({ item, parseCount(item.substr(0, colon)),
+                            parseCount(item.substr(colon + 1)) });
+        start = end + 1;
+    }
+    return recipes;
+}
+
+double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+Entry runOne(const fs::path& file, const Recipe& recipe, const fs::path& outDir, int reps) {
+    std::vector<double> load, carve, write, total;
+    Entry e;
+    e.image = file.filename().string();
+    e.recipe = recipe.label;
+    fs::path outFile = outDir / ("corpus_out" + file.extension().string());
+    for (int r = 0; r < reps; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        Image img(file.string());
+        double tLoad = msSince(t0);
+
+        e.width = img.getWidth();
+        e.height = img.getHeight();
+        e.seamsV = std::min(Recipe::resolve(recipe.vertical, e.width), e.width - 1);
+        e.seamsH = std::min(Recipe::resolve(recipe.horizontal, e.height), e.height - 1);
+
+        auto t1 = std::chrono::steady_clock::now();
+        SeamCarver sc(img);
+        sc.removeVerticalSeams(e.seamsV);
+        sc.removeHorizontalSeams(e.seamsH);
+        Image res = sc.getResult();
+        double tCarve = msSince(t1);
+
+        auto t2 = std::chrono::steady_clock::now();
+        res.write(outFile.string());
+        double tWrite = msSince(t2);
+
+        load.push_back(tLoad);
+        carve.push_back(tCarve);
+        write.push_back(tWrite);
+        total.push_back(tLoad + tCarve + tWrite);
+    }
+    fs::remove(outFile);
+    e.loadMs = median(load);
+    e.carveMs = median(carve);
+    e.writeMs = median(write);
+    e.totalMs = median(total);
+    return e;
+}
+
+void writeResults(std::ostream& out, const std::vector<Entry>& entries, int reps) {
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"schema\": 1,\n  \"repetitions\": " << reps << ",\n  \"results\": [";
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const Entry& e = entries[i];
+        out << (i ? ",\n" : "\n") << "    {\"image\": ";
+        writeJsonString(out, e.image);
+        out << ", \"recipe\": ";
+        writeJsonString(out, e.recipe);
+        out << ", \"width\": " << e.width << ", \"height\": " << e.height
+            << ", \"seams_v\": " << e.seamsV << ", \"seams_h\": " << e.seamsH
+            << ", \"load_ms\": " << e.loadMs << ", \"carve_ms\": " << e.carveMs
+            << ", \"write_ms\": " << e.writeMs << ", \"total_ms\": " << e.totalMs << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+/**
+ * @brief Compare against a baseline file.
+ * @return Number of regressions found.
+ */
+int compareBaseline(const std::vector<Entry>& entries, const std::string& baselineFile,
+                    double threshold, double minMs) {
+    std::ifstream in(baselineFile);
+    if (!in) throw std::runtime_error("Cannot open baseline file: " + baselineFile);
+    JsonValue base = JsonValue::parse(in);
+
+    int regressions = 0, matched = 0;
+    double logSum = 0;
+    std::cout << "\nBaseline comparison (threshold " << threshold << "x, floor " << minMs << " ms)\n";
+    for (const Entry& e : entries) {
+        const JsonValue* match = nullptr;
+        for (const auto& b : base.at("results").array) {
+            if (b.at("image").string == e.image && b.at("recipe").string == e.recipe) {
+                match = &b;
+                break;
+            }
+        }
+        std::cout << "  " << std::left << std::setw(32) << e.image << std::setw(12) << e.recipe;
+        if (!match) {
+            std::cout << "no baseline\n";
+            continue;
+        }
+        double before = match->at("total_ms").number;
+        double ratio = before > 0 ? e.totalMs / before : 1.0;
+        bool regressed = ratio > threshold && e.totalMs - before > minMs;
+        std::cout << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << before << " -> " << std::setw(10) << e.totalMs
+                  << " ms  (" << ratio << "x)" << (regressed ? "  REGRESSION" : "") << "\n";
+        regressions += regressed;
+        logSum += std::log(ratio);
+        ++matched;
+    }
+    if (matched) {
+        std::cout << "  geometric mean " << std::fixed << std::setprecision(3)
+                  << std::exp(logSum / matched) << "x over " << matched << " entries\n";
+    }
+    return regressions;
+}
+
+} // namespace
+
+/**
+ * @brief Entry point of the "corpus" subcommand.
+ */
+int runCorpus(int argc, char* argv[]) {
+    if (argc < 1) throw std::runtime_error("corpus expects <directory> [options]");
+    fs::path dir = argv[0];
+    std::string recipes = "10%:0,0:10%,10%:10%";
+    std::string jsonFile, baselineFile;
+    int reps = 3;
+    double threshold = 1.10, minMs = 1.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+            return argv[++i];
+        };
+        if      (arg == "--recipes")   recipes = value();
+        else if (arg == "--reps")      reps = std::max(1, std::atoi(value().c_str()));
+        else if (arg == "--json")      jsonFile = value();
+        else if (arg == "--baseline")  baselineFile = value();
+        else if (arg == "--threshold") threshold = std::atof(value().c_str());
+        else if (arg == "--min-ms")    minMs = std::atof(value().c_str());
+        else throw std::runtime_error("Unknown option: " + arg);
+    }
+
+    std::vector<fs::path> files;
+    for (const auto& de : fs::directory_iterator(dir)) {
+        auto ext = de.path().extension().string();
+        if (de.is_regular_file() && (ext == ".pgm" || ext == ".ppm")) files.push_back(de.path());
+    }
+    std::sort(files.begin(), files.end());
+    if (files.empty()) throw std::runtime_error("No .pgm/.ppm files in " + dir.string());
+
+    fs::path outDir = fs::temp_directory_path();
+    std::vector<Entry> entries;
+    for (const auto& f : files) {
+        for (const auto& r : parseRecipes(recipes)) {
+            Entry e = runOne(f, r, outDir, reps);
+            std::cout << std::left << std::setw(32) << e.image << std::setw(12) << e.recipe
+                      << std::right << std::fixed << std::setprecision(2)
+                      << " load " << std::setw(9) << e.loadMs
+                      << "  carve " << std::setw(9) << e.carveMs
+                      << "  write " << std::setw(9) << e.writeMs
+                      << "  total " << std::setw(9) << e.totalMs << " ms\n";
+            entries.push_back(e);
+        }
+    }
+
+    if (!jsonFile.empty()) {
+        std::ofstream out(jsonFile);
+        if (!out) throw std::runtime_error("Cannot open output file: " + jsonFile);
+        writeResults(out, entries, reps);
+    }
+    if (!baselineFile.empty()) {
+        int regressions = compareBaseline(entries, baselineFile, threshold, minMs);
+        if (regressions) {
+            std::cerr << regressions << " regression(s) above " << threshold << "x\n";
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file Generate.cpp
+ * @brief Writes reproducible synthetic images, e.g. to build a benchmark corpus.
+ */
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <stdexcept>
+#include <cstdlib>
+#include "Synthetic.hpp"
+#include "Bench.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Entry point of the "generate" subcommand.
+ */
+int runGenerate(int argc, char* argv[]) {
+    if (argc < 1) throw std::runtime_error("generate expects <directory> [options]");
+    fs::path dir = argv[0];
+    std::string sizes = "512x512";
+    std::string contents = "flat,gradient,noise,texture,natural,object";
+    std::uint32_t seed = 1;
+    bool gray = true, color = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+            return argv[++i];
+        };
+        if      (arg == "--sizes")   sizes = value();
+        else if (arg == "--content") contents = value();
+        else if (arg == "--seed")    seed = std::uint32_t(std::strtoul(value().c_str(), nullptr, 10));
+        else if (arg == "--gray")    { gray = true;  color = false; }
+        else if (arg == "--color")   { gray = false; color = true; }
+        else throw std::runtime_error("Unknown option: " + arg);
+    }
+
+    std::vector<Content> classes;
+    std::stringstream ss(contents);
+    std::string item;
+    while (std::getline(ss, item, ',')) classes.push_back(parseContent(item));
+
+    fs::create_directories(dir);
+    for (const auto& size : parseSizes(sizes)) {
+        for (Content c : classes) {
+            for (bool isColor : { false, true }) {
+                if ((isColor && !color) || (!isColor && !gray)) continue;
+                std::string name = std::string(contentName(c)) + "_" + std::to_string(size.width)
+                                 + "x" + std::to_string(size.height) + "_s" + std::to_string(seed)
+                                 + (isColor ? ".ppm" : ".pgm");
+                std::ofstream out(dir / name);
+                if (!out) throw std::runtime_error("Cannot open output file: " + name);
+                out << makeSyntheticPnm(c, size.width, size.height, isColor, seed);
+                std::cout << "Wrote " << (dir / name).string() << "\n";
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <numeric>
+#if defined(__linux__)
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+#include "Harness.hpp"
+#include "MemoryStats.hpp"
+
+double BenchResult::nsPerPixel() const {
+    return pixels ? mean * 1e9 / pixels : 0.0;
+}
+
+double BenchResult::gbPerSecond() const {
+    return mean > 0 ? bytes / mean / 1e9 : 0.0;
+}
+
+Harness::Harness(int warmup, int reps) : warmup_(warmup), reps_(std::max(1, reps)) {}
+
+/**
+ * @brief Time a kernel: warmup calls are discarded, then reps calls are sampled.
+ */
+BenchResult Harness::run(const std::string& name, std::size_t pixels, std::size_t bytes,
+                         const std::function<void()>& setup,
+                         const std::function<void()>& body) const {
+    for (int i = 0; i < warmup_; ++i) {
+        if (setup) setup();
+        body();
+    }
+    BenchResult r;
+    r.name = name;
+    r.pixels = pixels;
+    r.bytes = bytes;
+    r.samples.reserve(reps_);
+    std::uint64_t allocs = 0;
+    for (int i = 0; i < reps_; ++i) {
+        if (setup) setup();
+        std::uint64_t before = MemoryStats::snapshot().allocations;
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto stop = std::chrono::steady_clock::now();
+        allocs += MemoryStats::snapshot().allocations - before;
+        r.samples.push_back(std::chrono::duration<double>(stop - start).count());
+    }
+    r.allocations = double(allocs) / reps_;
+
+    r.mean = std::accumulate(r.samples.begin(), r.samples.end(), 0.0) / r.samples.size();
+    double var = 0;
+    for (double s : r.samples) var += (s - r.mean) * (s - r.mean);
+    r.stddev = r.samples.size() > 1 ? std::sqrt(var / (r.samples.size() - 1)) : 0.0;
+    std::vector<double> sorted = r.samples;
+    std::sort(sorted.begin(), sorted.end());
+    r.min = sorted.front();
+    r.median = sorted[sorted.size() / 2];
+    return r;
+}
+
+/**
+ * @brief Pin the calling thread to one CPU (Linux and Windows only).
+ */
+bool Harness::pinToCpu(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+void Harness::printHeader() {
+    std::printf("%-36s %12s %12s %10s %10s %9s %12s\n",
+                "kernel", "mean [us]", "median [us]", "cv [%]", "ns/pixel", "GB/s", "allocs/call");
+}
+
+void Harness::printResult(const BenchResult& r) {
+    double cv = r.mean > 0 ? 100.0 * r.stddev / r.mean : 0.0;
+    std::printf("%-36s %12.2f %12.2f %10.2f %10.3f %9.3f %12.1f\n",
+                r.name.c_str(), r.mean * 1e6, r.median * 1e6, cv,
+                r.nsPerPixel(), r.gbPerSecond(), r.allocations);
+}
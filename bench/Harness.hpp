@@ -0,0 +1,77 @@
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+/**
+ * @struct BenchResult
+ * @brief Timing summary of one benchmarked kernel.
+ */
+struct BenchResult {
+    std::string name;
+    std::size_t pixels = 0;      // pixels processed per repetition
+    std::size_t bytes = 0;       // bytes moved per repetition
+    std::vector<double> samples; // seconds per repetition
+    double allocations = 0;      // heap allocations per repetition
+    double mean = 0, stddev = 0, min = 0, median = 0;
+
+    /** @brief Mean nanoseconds per pixel. */
+    double nsPerPixel() const;
+
+    /** @brief Throughput in GB/s based on the mean time. */
+    double gbPerSecond() const;
+};
+
+/**
+ * @class Harness
+ * @brief Runs a kernel with warmup and repetitions and collects statistics.
+ */
+class Harness {
+private:
+    int warmup_, reps_;
+
+public:
+    Harness(int warmup, int reps);
+
+    /**
+     * @brief Time a kernel.
+     * @param name   Label used in reports.
+     * @param pixels Pixels processed by one call of body.
+     * @param bytes  Bytes read and written by one call of body.
+     * @param setup  Untimed preparation run before every call of body (may be empty).
+     * @param body   Timed kernel.
+     */
+    BenchResult run(const std::string& name, std::size_t pixels, std::size_t bytes,
+                    const std::function<void()>& setup,
+                    const std::function<void()>& body) const;
+
+    /**
+     * @brief Pin the calling thread to one CPU.
+     * @return false if pinning is not supported or failed.
+     */
+    static bool pinToCpu(int cpu);
+
+    /** @brief Print a table header for printResult(). */
+    static void printHeader();
+
+    /** @brief Print one result row. */
+    static void printResult(const BenchResult& r);
+};
+
+/**
+ * @brief Prevent the optimizer from discarding a computed value.
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+#endif // !BENCH_HARNESS_HPP
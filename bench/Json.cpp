@@ -0,0 +1,170 @@
+#include <map>
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <iterator>
+#include <stdexcept>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include "Json.hpp"
+
+namespace {
+
+class Parser {
+private:
+    const std::string& s_;
+    std::size_t pos_ = 0;
+
+    void skipSpace() {
+        while (pos_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[pos_]))) ++pos_;
+    }
+
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error(std::string("JSON: ") + what + " at offset " + std::to_string(pos_));
+    }
+
+    char peek() {
+        skipSpace();
+        if (pos_ >= s_.size()) fail("unexpected end of input");
+        return s_[pos_];
+    }
+
+    void expect(char c) {
+        if (peek() != c) fail("unexpected character");
+        ++pos_;
+    }
+
+    bool consume(const char* word) {
+        std::size_t n = std::char_traits<char>::length(word);
+        if (s_.compare(pos_, n, word) != 0) return false;
+        pos_ += n;
+        return true;
+    }
+
+    std::string parseString() {
+        expect('"');
+        std::string out;
+        while (pos_ < s_.size() && s_[pos_] != '"') {
+            char c = s_[pos_++];
+            if (c != '\\') { out += c; continue; }
+            if (pos_ >= s_.size()) break;
+            char e = s_[pos_++];
+            switch (e) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    // benchmark files only contain ASCII; keep the low byte
+                    if (pos_ + 4 > s_.size()) fail("bad escape");
+                    out += static_cast<char>(std::strtol(s_.substr(pos_, 4).c_str(), nullptr, 16));
+                    pos_ += 4;
+                    break;
+                }
+                default: out += e;
+            }
+        }
+        if (pos_ >= s_.size()) fail("unterminated string");
+        ++pos_;
+        return out;
+    }
+
+public:
+    explicit Parser(const std::string& s) : s_(s) {}
+
+    JsonValue parseValue() {
+        JsonValue v;
+        char c = peek();
+        if (c == '{') {
+            ++pos_;
+            v.type = JsonValue::Type::Object;
+            if (peek() == '}') { ++pos_; return v; }
+            for (;;) {
+                std::string key = parseString();
+                expect(':');
+                v.object[key] = parseValue();
+                if (peek() == ',') { ++pos_; continue; }
+                expect('}');
+                return v;
+            }
+        }
+        if (c == '[') {
+            ++pos_;
+            v.type = JsonValue::Type::Array;
+            if (peek() == ']') { ++pos_; return v; }
+            for (;;) {
+                v.array.push_back(parseValue());
+                if (peek() == ',') { ++pos_; continue; }
+                expect(']');
+                return v;
+            }
+        }
+        if (c == '"') {
+            v.type = JsonValue::Type::String;
+            v.string = parseString();
+            return v;
+        }
+        if (consume("true"))  { v.type = JsonValue::Type::Bool; v.boolean = true;  return v; }
+        if (consume("false")) { v.type = JsonValue::Type::Bool; v.boolean = false; return v; }
+        if (consume("null"))  return v;
+
+        const char* begin = s_.c_str() + pos_;
+        char* end = nullptr;
+        v.number = std::strtod(begin, &end);
+        if (end == begin) fail("invalid value");
+        v.type = JsonValue::Type::Number;
+        pos_ += end - begin;
+        return v;
+    }
+
+    void finish() {
+        skipSpace();
+        if (pos_ != s_.size()) fail("trailing characters");
+    }
+};
+
+} // namespace
+
+JsonValue JsonValue::parse(std::istream& in) {
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    Parser p(text);
+    JsonValue v = p.parseValue();
+    p.finish();
+    return v;
+}
+
+const JsonValue& JsonValue::at(const std::string& key) const {
+    if (type != Type::Object) throw std::runtime_error("JSON: not an object");
+    auto it = object.find(key);
+    if (it == object.end()) throw std::runtime_error("JSON: missing key \"" + key + "\"");
+    return it->second;
+}
+
+bool JsonValue::has(const std::string& key) const {
+    return type == Type::Object && object.count(key) != 0;
+}
+
+void writeJsonString(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c : s) {
+        switch (c) {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n";  break;
+            case '\t': out << "\\t";  break;
+            case '\r': out << "\\r";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out << buf;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
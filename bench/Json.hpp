@@ -0,0 +1,45 @@
+#include <map>
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+#ifndef BENCH_JSON_HPP
+#define BENCH_JSON_HPP
+
+/**
+ * @class JsonValue
+ * @brief Minimal JSON document model, enough to read back benchmark results.
+ */
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::map<std::string, JsonValue> object;
+
+    /**
+     * @brief Parse a complete JSON document.
+     * @throws runtime_error on syntax error.
+     */
+    static JsonValue parse(std::istream& in);
+
+    /**
+     * @brief Look up a member of an object.
+     * @throws runtime_error if this is not an object or the key is missing.
+     */
+    const JsonValue& at(const std::string& key) const;
+
+    /** @brief True if this is an object containing key. */
+    bool has(const std::string& key) const;
+};
+
+/**
+ * @brief Write s as a quoted JSON string literal.
+ */
+void writeJsonString(std::ostream& out, const std::string& s);
+
+#endif // !BENCH_JSON_HPP
@@ -0,0 +1,139 @@
+/**
+ * @file Micro.cpp
+ * @brief Microbenchmarks for the individual hot kernels of the carver.
+ */
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <cstdlib>
+#include "Image.hpp"
+#include "SeamCarver.hpp"
+#include "Kernels.hpp"
+#include "Qoi.hpp"
+#include "Harness.hpp"
+#include "Synthetic.hpp"
+#include "Bench.hpp"
+
+namespace {
+
+void runSize(const Harness& h, Size size, bool color, Content content) {
+    const int channels = color ? 3 : 1;
+    const std::size_t px = std::size_t(size.width) * size.height;
+    const std::size_t sampleBytes = px * channels * sizeof(int);
+    const std::string label = std::to_string(size.width) + "x" + std::to_string(size.height)
+                            + (color ? " rgb " : " gray ") + Kernels::get().name + " ";
+
+    std::string text = makeSyntheticPnm(content, size.width, size.height, color, 12345);
+    std::istringstream probe(text);
+    const Image image(probe);
+    SeamCarver carver(image);
+    auto energy = carver.computeEnergy();
+    auto seam = carver.findVerticalSeam(energy);
+
+    std::vector<BenchResult> results;
+    results.push_back(h.run(label + "parse", px, text.size(), {}, [&] {
+        std::istringstream in(text);
+        Image img(in);
+        doNotOptimize(img);
+    }));
+    std::string written;
+    results.push_back(h.run(label + "write", px, text.size(), {}, [&] {
+        std::ostringstream out;
+        image.write(out);
+        written = out.str();
+        doNotOptimize(written);
+    }));
+    if (color) {
+        std::ostringstream encoded;
+        QoiHeader header;
+        header.width = size.width;
+        header.height = size.height;
+        QoiCodec::encode(encoded, header, image.rowData(0), channels);
+        const std::string qoi = encoded.str();
+        results.push_back(h.run(label + "qoi decode", px, sampleBytes, {}, [&] {
+            std::istringstream in(qoi);
+            Image img(in);
+            doNotOptimize(img);
+        }));
+        results.push_back(h.run(label + "qoi encode", px, sampleBytes, {}, [&] {
+            std::ostringstream out;
+            QoiCodec::encode(out, header, image.rowData(0), channels);
+            written = out.str();
+            doNotOptimize(written);
+        }));
+    }
+    results.push_back(h.run(label + "computeEnergy", px, sampleBytes + px * sizeof(int), {}, [&] {
+        auto e = carver.computeEnergy();
+        doNotOptimize(e);
+    }));
+    // forward pass reads energy, writes and re-reads the cost matrix
+    results.push_back(h.run(label + "findVerticalSeam", px, 3 * px * sizeof(int), {}, [&] {
+        auto s = carver.findVerticalSeam(energy);
+        doNotOptimize(s);
+    }));
+    Image scratch = image;
+    results.push_back(h.run(label + "removeSeam", px, 2 * sampleBytes,
+                            [&] { scratch = image; },
+                            [&] { scratch.removeSeam(seam); doNotOptimize(scratch); }));
+    scratch = image;
+    results.push_back(h.run(label + "transpose", px, 2 * sampleBytes, {}, [&] {
+        scratch.transpose();
+        doNotOptimize(scratch);
+    }));
+
+    for (const auto& r : results) Harness::printResult(r);
+}
+
+} // namespace
+
+/**
+ * @brief Entry point of the "micro" subcommand.
+ */
+int runMicro(int argc, char* argv[]) {
+    std::string sizes = "256x256,1024x768,1920x1080";
+    int warmup = 2, reps = 10, cpu = -1;
+    bool gray = true, color = true;
+    Content content = Content::Noise;
+    std::string isa = Kernels::isaName(Kernels::active());
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+            return argv[++i];
+        };
+        if      (arg == "--sizes")  sizes = value();
+        else if (arg == "--warmup") warmup = std::atoi(value().c_str());
+        else if (arg == "--reps")   reps = std::atoi(value().c_str());
+        else if (arg == "--cpu")    cpu = std::atoi(value().c_str());
+        else if (arg == "--content") content = parseContent(value());
+        else if (arg == "--isa")     isa = value();
+        else if (arg == "--gray")   { gray = true;  color = false; }
+        else if (arg == "--color")  { gray = false; color = true; }
+        else throw std::runtime_error("Unknown option: " + arg);
+    }
+
+    if (cpu >= 0 && !Harness::pinToCpu(cpu))
+        std::cerr << "Warning: could not pin to CPU " << cpu << "\n";
+
+    std::vector<Kernels::Isa> isas;
+    for (int i = Kernels::Baseline; i < Kernels::IsaCount; ++i) {
+        Kernels::Isa candidate = Kernels::Isa(i);
+        if ((isa == "all" || isa == Kernels::isaName(candidate)) && candidate <= Kernels::detect())
+            isas.push_back(candidate);
+    }
+    if (isas.empty()) throw std::runtime_error("Instruction set not available: " + isa);
+
+    Harness h(warmup, reps);
+    Harness::printHeader();
+    for (Kernels::Isa level : isas) {
+        Kernels::select(level);
+        for (const auto& s : parseSizes(sizes)) {
+            if (gray)  runSize(h, s, false, content);
+            if (color) runSize(h, s, true, content);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file Scaling.cpp
+ * @brief Thread-scaling benchmark: one image carved with a growing thread
+ *        pool, and a batch of images carved concurrently.
+ */
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include "Image.hpp"
+#include "SeamCarver.hpp"
+#include "ThreadPool.hpp"
+#include "Profiler.hpp"
+#include "Trace.hpp"
+#include "Synthetic.hpp"
+#include "Json.hpp"
+#include "Bench.hpp"
+
+namespace {
+
+struct Row {
+    int threads = 0;
+    double singleSeconds = 0, barrierShare = 0;
+    double batchSeconds = 0;
+};
+
+double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// strip-parallel search settings for single-image runs (see SeamCarver::setStrips)
+int strips = 0, stripOverlap = 64;
+
+void carve(const Image& img, int numV, int numH, ThreadPool* pool, Profiler* profiler = nullptr) {
+    SeamCarver sc(img, pool);
+    sc.setProfiler(profiler);
+    if (pool) sc.setStrips(strips, stripOverlap);
+    sc.removeVerticalSeams(numV);
+    sc.removeHorizontalSeams(numH);
+}
+
+/**
+ * @brief Best-of-reps time for one image carved with `threads` threads.
+ */
+double timeSingle(const Image& img, int numV, int numH, int threads, int reps, double& barrierShare) {
+    ThreadPool pool(threads);
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        pool.resetStats();
+        auto start = std::chrono::steady_clock::now();
+        carve(img, numV, numH, &pool);
+        double t = seconds(start);
+        if (t < best) {
+            best = t;
+            auto s = pool.stats();
+            double total = s.computeSeconds + s.barrierSeconds;
+            barrierShare = total > 0 ? s.barrierSeconds / total : 0.0;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Best-of-reps time to carve every image of the batch, one image per thread at a time.
+ */
+double timeBatch(const std::vector<Image>& batch, int numV, int numH, int threads, int reps) {
+    ThreadPool pool(threads);
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        std::atomic<std::size_t> next{0};
+        auto start = std::chrono::steady_clock::now();
+        pool.run(threads, [&](int, int) {
+            for (std::size_t k; (k = next++) < batch.size(); )
+                carve(batch[k], numV, numH, nullptr);
+        });
+        best = std::min(best, seconds(start));
+    }
+    return best;
+}
+
+/**
+ * @brief Carve the batch once on `threads` threads with every phase traced,
+ *        one track per worker, followed by one image on the whole pool.
+ */
+void traceBatch(const std::vector<Image>& batch, int numV, int numH, int threads,
+                const std::string& file) {
+    Trace trace;
+    ThreadPool pool(threads);
+    std::atomic<std::size_t> next{0};
+    pool.run(threads, [&](int index, int) {
+        trace.setThreadName("worker " + std::to_string(index));
+        for (std::size_t k; (k = next++) < batch.size(); ) {
+            Trace::Scope scope(&trace, "image");
+            Profiler profiler;
+            profiler.setTrace(&trace);
+            carve(batch[k], numV, numH, nullptr, &profiler);
+        }
+    });
+    pool.setTrace(&trace);
+    Profiler profiler;
+    profiler.setTrace(&trace);
+    {
+        Trace::Scope scope(&trace, "single image");
+        carve(batch[0], numV, numH, &pool, &profiler);
+    }
+    trace.write(file);
+}
+
+} // namespace
+
+/**
+ * @brief Entry point of the "scaling" subcommand.
+ */
+int runScaling(int argc, char* argv[]) {
+    std::string size = "1920x1080", recipe = "32:0", jsonFile, traceFile;
+    Content content = Content::Natural;
+    int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    int batchSize = 0, reps = 3;
+    bool color = true;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+            return argv[++i];
+        };
+        if      (arg == "--size")        size = value();
+        else if (arg == "--content")     content = parseContent(value());
+        else if (arg == "--seams")       recipe = value();
+        else if (arg == "--max-threads") maxThreads = std::max(1, std::atoi(value().c_str()));
+        else if (arg == "--batch")       batchSize = std::atoi(value().c_str());
+        else if (arg == "--reps")        reps = std::max(1, std::atoi(value().c_str()));
+        else if (arg == "--json")        jsonFile = value();
+        else if (arg == "--trace")       traceFile = value();
+        else if (arg == "--strips")      strips = std::atoi(value().c_str());
+        else if (arg == "--strip-overlap") stripOverlap = std::atoi(value().c_str());
+        else if (arg == "--gray")        color = false;
+        else if (arg == "--color")       color = true;
+        else throw std::runtime_error("Unknown option: " + arg);
+    }
+    auto colon = recipe.find(':');
+    if (colon == std::string::npos) throw std::runtime_error("Invalid seams: " + recipe);
+    int numV = std::atoi(recipe.substr(0, colon).c_str());
+    int numH = std::atoi(recipe.substr(colon + 1).c_str());
+    Size dim = parseSizes(size).at(0);
+    if (numV >= dim.width || numH >= dim.height)
+        throw std::runtime_error("Seams exceed image size");
+    if (batchSize <= 0) batchSize = 2 * maxThreads;
+
+    std::vector<Image> batch;
+    for (int k = 0; k < batchSize; ++k) {
+        std::istringstream in(makeSyntheticPnm(content, dim.width, dim.height, color, 1000 + k));
+        batch.emplace_back(in);
+    }
+
+    std::vector<Row> rows;
+    for (int t = 1; t <= maxThreads; ++t) {
+        Row r;
+        r.threads = t;
+        r.singleSeconds = timeSingle(batch[0], numV, numH, t, reps, r.barrierShare);
+        r.batchSeconds = timeBatch(batch, numV, numH, t, reps);
+        rows.push_back(r);
+    }
+
+    const Row& base = rows.front();
+    std::cout << "image " << size << " " << contentName(content) << (color ? " rgb" : " gray")
+              << ", seams " << recipe << ", batch of " << batchSize << "\n\n"
+              << std::setw(7) << "threads"
+              << std::setw(12) << "single ms" << std::setw(9) << "speedup" << std::setw(9) << "eff %"
+              << std::setw(11) << "barrier %"
+              << std::setw(12) << "batch img/s" << std::setw(9) << "speedup" << std::setw(9) << "eff %"
+              << "\n" << std::fixed;
+    for (const Row& r : rows) {
+        double s1 = base.singleSeconds / r.singleSeconds;
+        double sb = base.batchSeconds / r.batchSeconds;
+        std::cout << std::setw(7) << r.threads
+                  << std::setprecision(2) << std::setw(12) << r.singleSeconds * 1e3
+                  << std::setw(9) << s1 << std::setprecision(1) << std::setw(9) << 100 * s1 / r.threads
+                  << std::setw(11) << 100 * r.barrierShare
+                  << std::setprecision(2) << std::setw(12) << batchSize / r.batchSeconds
+                  << std::setw(9) << sb << std::setprecision(1) << std::setw(9) << 100 * sb / r.threads
+                  << "\n";
+    }
+
+    if (!traceFile.empty()) traceBatch(batch, numV, numH, maxThreads, traceFile);
+
+    if (!jsonFile.empty()) {
+        std::ofstream out(jsonFile);
+        if (!out) throw std::runtime_error("Cannot open output file: " + jsonFile);
+        out << std::setprecision(6) << "{\n  \"schema\": 1,\n  \"size\": ";
+        writeJsonString(out, size);
+        out << ",\n  \"content\": ";
+        writeJsonString(out, contentName(content));
+        out << ",\n  \"seams\": ";
+        writeJsonString(out, recipe);
+        out << ",\n  \"batch\": " << batchSize << ",\n  \"results\": [";
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            const Row& r = rows[i];
+            out << (i ? ",\n" : "\n") << "    {\"threads\": " << r.threads
+                << ", \"single_ms\": " << r.singleSeconds * 1e3
+                << ", \"single_speedup\": " << base.singleSeconds / r.singleSeconds
+                << ", \"barrier_share\": " << r.barrierShare
+                << ", \"batch_images_per_s\": " << batchSize / r.batchSeconds
+                << ", \"batch_speedup\": " << base.batchSeconds / r.batchSeconds << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+    return EXIT_SUCCESS;
+}
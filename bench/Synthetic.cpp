@@ -0,0 +1,173 @@
+#include <string>
+#include <vector>
+#include <sstream>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include "Synthetic.hpp"
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+/**
+ * @class ValueNoise
+ * @brief Random values on a lattice, bilinearly interpolated.
+ */
+class ValueNoise {
+private:
+    int cells_;
+    std::vector<double> lattice_;
+
+public:
+    ValueNoise(int cells, std::mt19937& rng) : cells_(cells), lattice_((cells + 1) * (cells + 1)) {
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for (auto& v : lattice_) v = dist(rng);
+    }
+
+    /** @brief Sample at (u, v) in [0, 1]^2. */
+    double at(double u, double v) const {
+        double x = u * cells_, y = v * cells_;
+        int x0 = std::min(int(x), cells_ - 1), y0 = std::min(int(y), cells_ - 1);
+        double fx = x - x0, fy = y - y0;
+        auto L = [&](int r, int c) { return lattice_[r * (cells_ + 1) + c]; };
+        double top = L(y0, x0) * (1 - fx) + L(y0, x0 + 1) * fx;
+        double bot = L(y0 + 1, x0) * (1 - fx) + L(y0 + 1, x0 + 1) * fx;
+        return top * (1 - fy) + bot * fy;
+    }
+};
+
+int clamp255(double v) {
+    return std::clamp(int(std::lround(v)), 0, 255);
+}
+
+/**
+ * @brief Fill one channel plane (row-major) for the given content class.
+ * @param rng    Generator for per-channel detail.
+ * @param layout Generator for geometry that all channels share.
+ */
+void fillChannel(std::vector<int>& plane, Content content, int w, int h,
+                 std::mt19937& rng, std::mt19937 layout) {
+    std::uniform_int_distribution<int> byte(0, 255);
+    switch (content) {
+        case Content::Flat: {
+            std::fill(plane.begin(), plane.end(), byte(rng));
+            break;
+        }
+        case Content::Gradient: {
+            double a = byte(rng), b = byte(rng);
+            for (int i = 0; i < h; ++i)
+                for (int j = 0; j < w; ++j) {
+                    double t = (double(i) / h + double(j) / w) / 2.0;
+                    plane[i * w + j] = clamp255(a + (b - a) * t);
+                }
+            break;
+        }
+        case Content::Noise: {
+            for (auto& v : plane) v = byte(rng);
+            break;
+        }
+        case Content::Texture: {
+            std::uniform_real_distribution<double> period(6.0, 40.0), phase(0.0, 2 * kPi);
+            double px = period(rng), py = period(rng), ph = phase(rng);
+            for (int i = 0; i < h; ++i)
+                for (int j = 0; j < w; ++j)
+                    plane[i * w + j] = clamp255(127.5 + 127.5 * std::sin(2 * kPi * j / px + ph)
+                                                                * std::cos(2 * kPi * i / py));
+            break;
+        }
+        case Content::Natural: {
+            // octaves with amplitude halving as frequency doubles give a 1/f spectrum
+            std::vector<ValueNoise> octaves;
+            for (int cells = 2; cells <= std::max(w, h) / 2 && octaves.size() < 10; cells *= 2)
+                octaves.emplace_back(cells, rng);
+            for (int i = 0; i < h; ++i)
+                for (int j = 0; j < w; ++j) {
+                    double sum = 0, amp = 1, norm = 0;
+                    for (const auto& o : octaves) {
+                        sum += amp * o.at(double(j) / w, double(i) / h);
+                        norm += amp;
+                        amp *= 0.5;
+                    }
+                    plane[i * w + j] = clamp255(127.5 + 127.5 * sum / std::max(norm, 1.0));
+                }
+            break;
+        }
+        case Content::Object: {
+            std::uniform_real_distribution<double> unit(0.25, 0.75);
+            double cy = unit(layout) * h, cx = unit(layout) * w;
+            double radius = std::min(w, h) / 6.0;
+            double base = byte(rng) / 2.0 + 64;
+            for (int i = 0; i < h; ++i)
+                for (int j = 0; j < w; ++j) {
+                    double dy = i - cy, dx = j - cx;
+                    bool inside = dy * dy + dx * dx <= radius * radius;
+                    plane[i * w + j] = inside ? byte(rng)
+                                              : clamp255(base + 16.0 * double(j) / w);
+                }
+            break;
+        }
+    }
+}
+
+} // namespace
+
+std::vector<Size> parseSizes(const std::string& arg) {
+    std::vector<Size> sizes;
+    std::stringstream ss(arg);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        auto x = item.find('x');
+        if (x == std::string::npos) throw std::runtime_error("Invalid size: " + item);
+        Size s{ std::atoi(item.substr(0, x).c_str()), std::atoi(item.substr(x + 1).c_str()) };
+        if (s.width < 3 || s.height < 3) throw std::runtime_error("Invalid size: " + item);
+        sizes.push_back(s);
+    }
+    return sizes;
+}
+
+Content parseContent(const std::string& name) {
+    for (Content c : { Content::Flat, Content::Gradient, Content::Noise,
+                       Content::Texture, Content::Natural, Content::Object })
+        if (name == contentName(c)) return c;
+    throw std::runtime_error("Unknown content class: " + name);
+}
+
+const char* contentName(Content content) {
+    switch (content) {
+        case Content::Flat:     return "flat";
+        case Content::Gradient: return "gradient";
+        case Content::Noise:    return "noise";
+        case Content::Texture:  return "texture";
+        case Content::Natural:  return "natural";
+        case Content::Object:   return "object";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Produce a synthetic P2/P3 image. Each channel is drawn independently
+ *        from the same content class, sharing object placement.
+ */
+std::string makeSyntheticPnm(Content content, int width, int height, bool color,
+                             std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    int channels = color ? 3 : 1;
+    std::vector<std::vector<int>> planes(channels, std::vector<int>(std::size_t(width) * height));
+    std::mt19937 layout(seed ^ 0x9e3779b9u);
+    for (auto& p : planes) fillChannel(p, content, width, height, rng, layout);
+
+    std::ostringstream out;
+    out << (color ? "P3" : "P2") << '\n'
+        << "# synthetic " << contentName(content) << " seed " << seed << '\n'
+        << width << ' ' << height << '\n' << 255 << '\n';
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j)
+            for (int c = 0; c < channels; ++c)
+                out << planes[c][std::size_t(i) * width + j] << ' ';
+        out << '\n';
+    }
+    return out.str();
+}
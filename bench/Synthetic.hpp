@@ -0,0 +1,54 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#ifndef BENCH_SYNTHETIC_HPP
+#define BENCH_SYNTHETIC_HPP
+
+/**
+ * @brief Content classes of synthetic images, chosen to cover best and worst
+ *        cases of the seam search (uniform costs, many ties, high contrast).
+ */
+enum class Content {
+    Flat,     // constant value
+    Gradient, // diagonal linear ramp
+    Noise,    // uniform white noise
+    Texture,  // periodic sinusoidal pattern
+    Natural,  // 1/f fractal noise resembling photographs
+    Object    // smooth background with one high-energy disc
+};
+
+/**
+ * @struct Size
+ * @brief Dimensions of a synthetic image.
+ */
+struct Size { int width, height; };
+
+/**
+ * @brief Parse "WxH[,WxH...]" into a list of sizes.
+ * @throws runtime_error on malformed or too small sizes.
+ */
+std::vector<Size> parseSizes(const std::string& arg);
+
+/**
+ * @brief Parse a content class name ("flat", "gradient", "noise", "texture",
+ *        "natural", "object").
+ * @throws runtime_error on unknown names.
+ */
+Content parseContent(const std::string& name);
+
+/** @brief Lower-case name of a content class. */
+const char* contentName(Content content);
+
+/**
+ * @brief Produce a P2 (gray) or P3 (color) image with values in [0, 255] as PNM text.
+ * @param content Content class.
+ * @param width   Image width.
+ * @param height  Image height.
+ * @param color   true for P3, false for P2.
+ * @param seed    Random seed; equal arguments give identical images.
+ */
+std::string makeSyntheticPnm(Content content, int width, int height, bool color,
+                             std::uint32_t seed);
+
+#endif // !BENCH_SYNTHETIC_HPP
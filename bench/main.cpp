@@ -0,0 +1,75 @@
+/**
+ * @file main.cpp
+ * @brief Benchmark driver for the seamcarve library.
+ *
+ * Subcommands:
+ *   carve <input> <#vertical> <#horizontal> [<repetitions>]
+ *       Wall time of a full carve of one image.
+ *   micro [--sizes WxH,...] [--content CLASS] [--warmup N] [--reps N] [--cpu K]
+ *         [--isa baseline|avx2|avx512|all] [--gray|--color]
+ *       Per-kernel timings on synthetic images.
+ *   corpus <dir> [--recipes V:H,...] [--reps N] [--json out.json]
+ *          [--baseline base.json] [--threshold RATIO] [--min-ms MS]
+ *       Load, carve and write every image in a directory; optionally fail
+ *       on regressions against a stored baseline.
+ *   generate <dir> [--sizes WxH,...] [--content CLASS,...] [--seed N] [--gray|--color]
+ *       Write seeded synthetic images (flat, gradient, noise, texture,
+ *       natural, object) to a directory.
+ *   scaling [--size WxH] [--content CLASS] [--seams V:H] [--max-threads N]
+ *           [--batch K] [--reps N] [--json out.json] [--trace trace.json]
+ *           [--gray|--color] [--strips N [--strip-overlap K]]
+ *       Speedup and parallel efficiency for 1..N threads, both for one
+ *       image and for a batch of images carved concurrently.
+ */
+
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <cstdlib>
+#include "Image.hpp"
+#include "SeamCarver.hpp"
+#include "Bench.hpp"
+
+/**
+ * @brief Entry point of the "carve" subcommand.
+ */
+int runCarve(int argc, char* argv[]) {
+    if (argc < 3 || argc > 4)
+        throw std::runtime_error("carve expects <input> <#vertical> <#horizontal> [<repetitions>]");
+    std::string infile = argv[0];
+    int numV = std::atoi(argv[1]);
+    int numH = std::atoi(argv[2]);
+    int reps = (argc == 4 ? std::atoi(argv[3]) : 5);
+
+    Image img(infile);
+    for (int r = 0; r < reps; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        SeamCarver sc(img);
+        sc.removeVerticalSeams(numV);
+        sc.removeHorizontalSeams(numH);
+        auto stop = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::milli> ms = stop - start;
+        std::cout << "run " << r << ": " << ms.count() << " ms\n";
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <carve|micro|corpus|generate|scaling> [options]\n";
+        return EXIT_FAILURE;
+    }
+    std::string cmd = argv[1];
+    try {
+        if (cmd == "carve") return runCarve(argc - 2, argv + 2);
+        if (cmd == "micro") return runMicro(argc - 2, argv + 2);
+        if (cmd == "corpus") return runCorpus(argc - 2, argv + 2);
+        if (cmd == "generate") return runGenerate(argc - 2, argv + 2);
+        if (cmd == "scaling") return runScaling(argc - 2, argv + 2);
+        std::cerr << "Unknown subcommand: " << cmd << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Fatal: " << e.what() << "\n";
+    }
+    return EXIT_FAILURE;
+}
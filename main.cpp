@@ -5,48 +5,393 @@
  * Reads a PGM (P2) image, preserves any initial comment lines, removes specified vertical
  * and horizontal seams, and writes the resized image to a new PGM file matching original
  * formatting (including comments and whitespace) so that plain `diff` shows no differences.
+ *
+ * Options:
+ *   --threads N          Use N threads for the energy and seam search passes.
+ *   --strips N           Approximate seam search in N row strips carved
+ *                        concurrently on the --threads pool (default: exact).
+ *   --strip-overlap K    Rows each strip starts early (default 64).
+ *   --cost auto|32|64    Integer width of the seam costs (default auto: 64 bits
+ *                        only where 32 could overflow; 32 fails on such images).
+ *   --energy-channels L  Comma-separated channels the energy is computed from,
+ *                        e.g. 0,1,2 to ignore the alpha of RGBA (default: all).
+ *   --stats              Print a per-phase timing breakdown.
+ *   --stats-json FILE    Write the breakdown as JSON to FILE ("-" for stdout,
+ *                        unless stdout carries images with --stream or a pipe).
+ *   --trace FILE         Write Chrome trace events for every seam and phase to FILE.
+ *   --counters           Add hardware counters (IPC, cache and branch misses per
+ *                        pixel) to the --stats breakdown; Linux only.
+ *   --memory             Add allocation counts, heap growth and RSS per phase to
+ *                        the --stats breakdown.
+ *   --video              Treat the input as a frame sequence: a pattern such as
+ *                        frame_%04d.ppm, a file of concatenated images, or a
+ *                        YUV4MPEG2 stream (.y4m, or "-" for stdin to stdout).
+ *   --first N            Number of the first frame of a pattern (default 1).
+ *   --band R             Search each seam within R pixels of the previous frame's
+ *                        seam (default 8, 0 = full search every frame).
+ *   --keyframe N         Full search every N frames (default: first frame only).
+ *   --scene-cut T        Luma histogram difference that starts a new scene
+ *                        (default 0.35, 0 = off); seams restart at each cut.
+ *   --segments           Carve scenes concurrently on the --threads pool
+ *                        (frame patterns and .y4m files only).
+ *   --max-segment N      With --segments, split scenes longer than N frames.
+ *   --out-of-core        Keep pixels in memory-mapped scratch files instead of
+ *                        RAM, for images larger than memory; also reads and
+ *                        writes binary P5/P6.
+ *   --scratch DIR        Directory for the scratch files (default: the output's).
+ *   --gzip               Gzip compress the output (appends .gz); gzip inputs
+ *                        such as image.ppm.gz produce gzip output anyway.
+ *   --format F           Output format: ascii (P2/P3), binary (P5/P6), pam (P7)
+ *                        or qoi; the extension follows (default: the input's).
+ *                        Float (PFM) images are written as PFM regardless.
+ *   --stream             Treat the input as concatenated images (implied by
+ *                        "-" for stdin) and carve each one on its own, writing
+ *                        the results to stdout in order, one image at a time.
  */
 
 #include <string>
 #include <array>
+#include <vector>
+#include <sstream>
+#include <memory>
+#include <utility>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <cstdlib>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
 #include "Image.hpp"
 #include "SeamCarver.hpp"
+#include "ThreadPool.hpp"
+#include "Profiler.hpp"
+#include "Trace.hpp"
+#include "PerfCounters.hpp"
+#include "Kernels.hpp"
+#include "VideoCarver.hpp"
+#include "FrameSequence.hpp"
+#include "Y4M.hpp"
+#include "ParallelVideoCarver.hpp"
+#include "OutOfCoreCarver.hpp"
+#include "Gzip.hpp"
 
 int main(int argc, char* argv[]) {
-    if (argc != 4) {
-        std::cerr << "Usage: " << argv[0] << " <input.pgm> <#vertical> <#horizontal>\n";
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <input.pgm> <#vertical> <#horizontal>"
+                  << " [--threads N [--strips N [--strip-overlap K]]] [--cost auto|32|64]"
+                  << " [--energy-channels L] [--stats] [--stats-json FILE] [--trace FILE]"
+                  << " [--counters] [--memory]"
+                  << " [--video [--first N] [--band R] [--keyframe N] [--scene-cut T]"
+                  << " [--segments [--max-segment N]]]"
+                  << " [--out-of-core [--scratch DIR]] [--gzip] [--format F] [--stream]\n";
         return EXIT_FAILURE;
     }
     std::string infile = argv[1];
     int numV = std::atoi(argv[2]);
     int numH = std::atoi(argv[3]);
 
-    try {
-        Image img(infile);
-        if (numV >= img.getWidth() || numH >= img.getHeight()) {
-            std::cerr << "Error: requested seams (" << numV << "," << numH
-                      << ") exceed dimensions (" << img.getWidth()
-                      << "," << img.getHeight() << ")\n";
+    int threads = 1;
+    bool stats = false, counters = false, memory = false, video = false, segments = false;
+    bool outOfCore = false, gzip = false, stream = false;
+    int first = 1, band = 8, keyframe = 0, maxSegment = 0;
+    int strips = 0, stripOverlap = 64;
+    double sceneCut = 0.35;
+    SeamCarver::CostType costType = SeamCarver::AutoCost;
+    Image::Format format = Image::BinaryFormat;
+    bool convert = false;
+    std::vector<int> energyChannels;
+    std::string statsJson, traceFile, scratchDir;
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stats") {
+            stats = true;
+        } else if (arg == "--counters") {
+            counters = stats = true;
+        } else if (arg == "--memory") {
+            memory = stats = true;
+        } else if (arg == "--video") {
+            video = true;
+        } else if (arg == "--segments") {
+            segments = video = true;
+        } else if (arg == "--out-of-core") {
+            outOfCore = true;
+        } else if (arg == "--gzip") {
+            gzip = true;
+        } else if (arg == "--stream") {
+            stream = true;
+        } else if (arg == "--scratch" && i + 1 < argc) {
+            scratchDir = argv[++i];
+        } else if (arg == "--cost" && i + 1 < argc) {
+            if (!SeamCarver::parseCostType(argv[++i], costType)) {
+                std::cerr << "Unknown cost type: " << argv[i] << "\n";
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--format" && i + 1 < argc) {
+            if (!Image::parseFormat(argv[++i], format)) {
+                std::cerr << "Unknown format: " << argv[i] << "\n";
+                return EXIT_FAILURE;
+            }
+            convert = true;
+        } else if (arg == "--energy-channels" && i + 1 < argc) {
+            std::istringstream list(argv[++i]);
+            for (std::string c; std::getline(list, c, ',');) energyChannels.push_back(std::atoi(c.c_str()));
+        } else if (arg == "--scene-cut" && i + 1 < argc) {
+            sceneCut = std::atof(argv[++i]);
+        } else if ((arg == "--first" || arg == "--band" || arg == "--keyframe"
+                    || arg == "--max-segment" || arg == "--strips" || arg == "--strip-overlap")
+                   && i + 1 < argc) {
+            int value = std::atoi(argv[++i]);
+            if      (arg == "--first")       first = value;
+            else if (arg == "--band")        band = value;
+            else if (arg == "--keyframe")    keyframe = value;
+            else if (arg == "--strips")      strips = value;
+            else if (arg == "--strip-overlap") stripOverlap = value;
+            else                             maxSegment = value;
+        } else if ((arg == "--threads" || arg == "--stats-json" || arg == "--trace") && i + 1 < argc) {
+            if      (arg == "--threads")    threads = std::atoi(argv[++i]);
+            else if (arg == "--stats-json") statsJson = argv[++i];
+            else                            traceFile = argv[++i];
+        } else {
+            std::cerr << "Unknown or incomplete option: " << arg << "\n";
             return EXIT_FAILURE;
         }
-        SeamCarver sc(img);
-        sc.removeVerticalSeams(numV);
-        sc.removeHorizontalSeams(numH);
-        auto res = sc.getResult();
-
-        auto pos = infile.find_last_of('.');
-        std::string base = (pos==std::string::npos ? infile : infile.substr(0,pos));
-        std::string ext  = (pos==std::string::npos ? ".pgm" : infile.substr(pos));
-        std::string outfile = base + "_processed_" + std::to_string(numV)
-                            + "_" + std::to_string(numH) + ext;
-        res.write(outfile);
-        std::cout << "Saved: " << outfile << "\n";
+    }
+
+    try {
+        Trace trace;
+        Profiler profiler;
+        Profiler* prof = (stats || !statsJson.empty() || !traceFile.empty()) ? &profiler : nullptr;
+        std::unique_ptr<ThreadPool> pool;
+        if (threads != 1) pool = std::make_unique<ThreadPool>(threads);
+        profiler.setMemoryTracking(memory || !statsJson.empty());
+        std::unique_ptr<PerfCounters> perf;
+        if (counters) {
+            perf = std::make_unique<PerfCounters>();
+            profiler.setCounters(perf.get());
+        }
+        if (!traceFile.empty()) {
+            trace.setThreadName("main");
+            profiler.setTrace(&trace);
+            if (pool) pool->setTrace(&trace);
+        }
+
+        // image.ppm.gz is named like image.ppm, and its output stays compressed
+        const bool gzipIn = isGzipName(infile);
+        const std::string stem = gzipIn ? infile.substr(0, infile.size() - 3) : infile;
+        auto pos = stem.find_last_of('.');
+        std::string base = (pos==std::string::npos ? stem : stem.substr(0,pos));
+        std::string ext  = (pos==std::string::npos ? ".pgm" : stem.substr(pos));
+        const std::string suffix = "_processed_" + std::to_string(numV) + "_" + std::to_string(numH);
+        const std::string gzExt = gzip || gzipIn ? ".gz" : "";
+        std::string outfile = base + suffix + ext + gzExt;
+        if (gzip && video) throw std::runtime_error("--gzip works on single images");
+        if (convert && video) throw std::runtime_error("--format works on single images and --stream");
+
+        // a Y4M pipe or an image stream owns stdout, so everything else goes to stderr
+        const bool pipe = video && infile == "-";
+        if (!video && infile == "-") stream = true;
+        std::ostream& info = pipe || stream ? std::cerr : std::cout;
+        if (stream && (video || outOfCore || gzip))
+            throw std::runtime_error("--stream cannot be combined with --video, --out-of-core or --gzip");
+        if ((pipe || stream) && statsJson == "-")
+            throw std::runtime_error("--stats-json - needs stdout, which carries the images here; give a file");
+        if (pipe || stream) {
+#ifdef _WIN32
+            _setmode(_fileno(stdin), _O_BINARY);
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            std::ios::sync_with_stdio(false);
+        }
+
+        if (stream) {
+            FrameReader reader(infile, 0);
+            FrameWriter writer("-", 0);
+            long long images = 0;
+            for (;;) {
+                std::unique_ptr<Image> img;
+                {
+                    Profiler::Scope scope(prof, Profiler::Load);
+                    img = reader.next();
+                }
+                if (!img) break;
+                profiler.addPixels(Profiler::Load, (long long)img->getWidth() * img->getHeight());
+                if (numV >= img->getWidth() || numH >= img->getHeight())
+                    throw std::runtime_error("requested seams exceed the dimensions of image "
+                                             + std::to_string(images + 1));
+                SeamCarver sc(std::move(*img), pool.get());
+                img.reset();
+                sc.setProfiler(prof);
+                sc.setCostType(costType);
+                sc.setEnergyChannels(energyChannels);
+                sc.setStrips(strips, stripOverlap);
+                sc.removeVerticalSeams(numV);
+                sc.removeHorizontalSeams(numH);
+                Image res = sc.takeResult();
+                Profiler::Scope scope(prof, Profiler::Write, (long long)res.getWidth() * res.getHeight());
+                if (convert) res.convertTo(format);
+                writer.write(res);
+                ++images;
+            }
+            info << "Saved: <stdout> (" << images << " images)\n";
+        } else if (outOfCore) {
+            if (video) throw std::runtime_error("--out-of-core works on single images");
+            if (scratchDir.empty()) {
+                auto slash = outfile.find_last_of("/\\");
+                scratchDir = slash == std::string::npos ? "." : outfile.substr(0, slash);
+            }
+            std::unique_ptr<OutOfCoreCarver> carver;
+            {
+                Profiler::Scope scope(prof, Profiler::Load);
+                carver = std::make_unique<OutOfCoreCarver>(infile, scratchDir);
+            }
+            profiler.addPixels(Profiler::Load, (long long)carver->getWidth() * carver->getHeight());
+            if (convert) {
+                carver->setFormat(format);
+                outfile = base + suffix + Image::extensionFor(format, carver->getChannels()) + gzExt;
+            }
+            if (numV >= carver->getWidth() || numH >= carver->getHeight()) {
+                std::cerr << "Error: requested seams (" << numV << "," << numH
+                          << ") exceed dimensions (" << carver->getWidth()
+                          << "," << carver->getHeight() << ")\n";
+                return EXIT_FAILURE;
+            }
+            carver->setProfiler(prof);
+            carver->setCostType(costType);
+            carver->setEnergyChannels(energyChannels);
+            carver->removeVerticalSeams(numV);
+            carver->removeHorizontalSeams(numH);
+            carver->write(outfile);
+            std::cout << "Saved: " << outfile << "\n";
+        } else if (segments) {
+            if (pipe || !(ext == ".y4m" || FramePattern::isPattern(infile)))
+                throw std::runtime_error("--segments needs a frame pattern or a .y4m file");
+            if (!pool) pool = std::make_unique<ThreadPool>(threads);
+            ParallelVideoCarver carver(numV, numH, *pool);
+            carver.setBand(band);
+            carver.setKeyframeInterval(keyframe);
+            carver.setSceneCutThreshold(sceneCut);
+            carver.setMaxSegment(maxSegment);
+            long long frames = ext == ".y4m" ? carver.carveY4M(infile, outfile)
+                                             : carver.carveFrames(infile, outfile, first);
+            info << "Saved: " << outfile << " (" << frames << " frames, "
+                 << carver.segments().size() << " segments)\n";
+            if (stats) info << "per-phase timings are not collected with --segments\n";
+        } else if (video && (pipe || ext == ".y4m")) {
+            std::ifstream file;
+            std::ofstream outFile;
+            if (!pipe) {
+                file.open(infile, std::ios::binary);
+                if (!file) throw std::runtime_error("Cannot open input file");
+            }
+            Y4MReader reader(pipe ? std::cin : file);
+            if (numV >= reader.header().width || numH >= reader.header().height) {
+                std::cerr << "Error: requested seams (" << numV << "," << numH
+                          << ") exceed dimensions (" << reader.header().width
+                          << "," << reader.header().height << ")\n";
+                return EXIT_FAILURE;
+            }
+            if (!pipe) {
+                outFile.open(outfile, std::ios::binary);
+                if (!outFile) throw std::runtime_error("Cannot open output file");
+            }
+            Y4MHeader outHeader = reader.header();
+            outHeader.width -= numV;
+            outHeader.height -= numH;
+            Y4MWriter writer(pipe ? std::cout : outFile, outHeader);
+            VideoCarver carver(numV, numH, pool.get());
+            carver.setBand(band);
+            carver.setKeyframeInterval(keyframe);
+            carver.setSceneCutThreshold(sceneCut);
+            carver.setProfiler(prof);
+            std::vector<Image> planes;
+            const long long pixels = (long long)reader.header().width * reader.header().height;
+            for (;;) {
+                {
+                    Profiler::Scope scope(prof, Profiler::Load);
+                    if (!reader.next(planes)) break;
+                }
+                profiler.addPixels(Profiler::Load, pixels);
+                std::vector<Image> res = carveY4MFrame(carver, reader.header(), std::move(planes));
+                Profiler::Scope scope(prof, Profiler::Write,
+                                      (long long)outHeader.width * outHeader.height);
+                writer.write(res);
+            }
+            std::cout.flush();
+            info << "Saved: " << (pipe ? "<stdout>" : outfile) << " (" << carver.frames()
+                 << " frames, " << carver.sceneCuts() << " scene cuts)\n";
+        } else if (video) {
+            FrameReader reader(infile, first);
+            FrameWriter writer(outfile, first);
+            VideoCarver carver(numV, numH, pool.get());
+            carver.setBand(band);
+            carver.setKeyframeInterval(keyframe);
+            carver.setSceneCutThreshold(sceneCut);
+            carver.setProfiler(prof);
+            for (;;) {
+                std::unique_ptr<Image> frame;
+                {
+                    Profiler::Scope scope(prof, Profiler::Load);
+                    frame = reader.next();
+                }
+                if (!frame) break;
+                profiler.addPixels(Profiler::Load, (long long)frame->getWidth() * frame->getHeight());
+                Image res = carver.carve(std::move(*frame));
+                Profiler::Scope scope(prof, Profiler::Write, (long long)res.getWidth() * res.getHeight());
+                writer.write(res);
+            }
+            writer.finish();
+            if (carver.frames() == 0) throw std::runtime_error("No frames in input");
+            std::cout << "Saved: " << outfile << " (" << carver.frames() << " frames, "
+                      << carver.sceneCuts() << " scene cuts)\n";
+        } else {
+            std::unique_ptr<Image> loaded;
+            {
+                Profiler::Scope scope(prof, Profiler::Load);
+                loaded = std::make_unique<Image>(infile);
+            }
+            const Image& img = *loaded;
+            profiler.addPixels(Profiler::Load, (long long)img.getWidth() * img.getHeight());
+            if (numV >= img.getWidth() || numH >= img.getHeight()) {
+                std::cerr << "Error: requested seams (" << numV << "," << numH
+                          << ") exceed dimensions (" << img.getWidth()
+                          << "," << img.getHeight() << ")\n";
+                return EXIT_FAILURE;
+            }
+            SeamCarver sc(std::move(*loaded), pool.get());
+            sc.setProfiler(prof);
+            sc.setCostType(costType);
+            sc.setEnergyChannels(energyChannels);
+            sc.setStrips(strips, stripOverlap);
+            sc.removeVerticalSeams(numV);
+            sc.removeHorizontalSeams(numH);
+            Image res = sc.takeResult();
+            {
+                Profiler::Scope scope(prof, Profiler::Write, (long long)res.getWidth() * res.getHeight());
+                // float images have no integer format to go to and keep their name
+                if (convert && res.convertTo(format))
+                    outfile = base + suffix + Image::extensionFor(format, res.getChannels()) + gzExt;
+                res.write(outfile);
+            }
+            std::cout << "Saved: " << outfile << "\n";
+        }
+
+        if (!traceFile.empty()) trace.write(traceFile);
+        if (stats) {
+            info << "kernels: " << Kernels::get().name << "\n";
+            profiler.report(info);
+        }
+        if (statsJson == "-") {
+            profiler.reportJson(std::cout);
+        } else if (!statsJson.empty()) {
+            std::ofstream out(statsJson);
+            if (!out) throw std::runtime_error("Cannot open stats file");
+            profiler.reportJson(out);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Fatal: " << e.what() << "\n";
         return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
 }
-
@@ -1,19 +1,128 @@
 -- premake5.lua
 workspace "seam-carving"
-   configurations { "Debug", "Release" }
+   -- ReleaseLTO: Release plus link-time optimization across the library.
+   -- PGOGenerate/PGOUse: the two halves of a profile-guided build; run
+   -- `premake5 pgo` to do both with training in between (see README).
+   configurations { "Debug", "Release", "ReleaseLTO", "PGOGenerate", "PGOUse" }
    location "build"
 
-project "seam-carving"
-   kind "ConsoleApp"
-
    language "C++"
+   cppdialect "C++17"
 
-   files { "**.hpp", "**.cpp" }
+   targetdir "bin/%{cfg.buildcfg}"
+   objdir "obj/%{cfg.buildcfg}"
 
    filter "configurations:Debug"
       defines { "DEBUG" }
       symbols "On"
 
-   filter "configurations:Release"
+   filter "configurations:Release or ReleaseLTO or PGO*"
       defines { "NDEBUG" }
       optimize "On"
+
+   filter "configurations:ReleaseLTO or PGO*"
+      linktimeoptimization "On"
+
+   -- both PGO steps compile to the same object paths, otherwise the profile
+   -- written by the instrumented objects is not found when optimizing
+   filter "configurations:PGO*"
+      objdir "obj/PGO"
+
+   filter { "configurations:PGOGenerate", "toolset:gcc" }
+      buildoptions { "-fprofile-generate=%{wks.location}/../pgo", "-fprofile-update=atomic" }
+      linkoptions { "-fprofile-generate=%{wks.location}/../pgo" }
+
+   filter { "configurations:PGOUse", "toolset:gcc" }
+      buildoptions { "-fprofile-use=%{wks.location}/../pgo", "-fprofile-correction", "-Wno-missing-profile" }
+      linkoptions { "-fprofile-use=%{wks.location}/../pgo" }
+
+   filter { "configurations:PGOGenerate", "toolset:clang" }
+      buildoptions { "-fprofile-generate=%{wks.location}/../pgo" }
+      linkoptions { "-fprofile-generate=%{wks.location}/../pgo" }
+
+   filter { "configurations:PGOUse", "toolset:clang" }
+      buildoptions { "-fprofile-use=%{wks.location}/../pgo/default.profdata", "-Wno-profile-instr-unprofiled" }
+      linkoptions { "-fprofile-use=%{wks.location}/../pgo/default.profdata" }
+
+   filter { "configurations:PGOGenerate", "toolset:msc*" }
+      linkoptions { "/GENPROFILE" }
+
+   filter { "configurations:PGOUse", "toolset:msc*" }
+      linkoptions { "/USEPROFILE" }
+
+   filter {}
+
+-- Carving engine (Image, SeamCarver) as a static library so services and
+-- benchmarks can link it without the CLI's main().
+project "seamcarve"
+   kind "StaticLib"
+
+   files { "*.hpp", "*.cpp" }
+   removefiles { "main.cpp", "AllocHook.cpp" }
+
+-- Command line front end.
+project "seam-carving"
+   kind "ConsoleApp"
+
+   files { "main.cpp", "AllocHook.cpp" }
+   links { "seamcarve" }
+
+   filter "system:not windows"
+      links { "pthread" }
+
+-- Benchmark driver.
+project "seamcarve-bench"
+   kind "ConsoleApp"
+
+   files { "bench/**.hpp", "bench/**.cpp", "AllocHook.cpp" }
+   includedirs { "." }
+   links { "seamcarve" }
+
+   filter "system:not windows"
+      links { "pthread" }
+
+-- Unit tests; the runner exits non-zero if any test fails.
+project "seamcarve-tests"
+   kind "ConsoleApp"
+
+   files { "tests/**.hpp", "tests/**.cpp" }
+   includedirs { "." }
+   links { "seamcarve" }
+
+   filter "system:not windows"
+      links { "pthread" }
+
+-- Profile-guided build with GNU make: instrument, train on the synthetic
+-- benchmark corpus, then rebuild with the collected profile.
+newaction {
+   trigger = "pgo",
+   description = "Build PGOGenerate, train it on a synthetic corpus and build PGOUse (GNU make)",
+
+   execute = function()
+      local function run(cmd)
+         print("> " .. cmd)
+         if not os.execute(cmd) then error("command failed: " .. cmd, 0) end
+      end
+      local cc = _OPTIONS["cc"] and (" --cc=" .. _OPTIONS["cc"]) or ""
+      local bench = "bin/PGOGenerate/seamcarve-bench"
+      local cli = "bin/PGOGenerate/seam-carving"
+
+      os.rmdir("pgo")
+      run(_PREMAKE_COMMAND .. cc .. " gmake")
+      run("make -C build config=pgogenerate clean")
+      run("make -C build config=pgogenerate -j4")
+
+      -- training workload: every content class, both pixel formats, all kernels
+      run(bench .. " generate pgo-corpus --sizes 256x256,1024x768 --seed 1")
+      run(bench .. " corpus pgo-corpus --reps 1")
+      run(bench .. " micro --sizes 512x512 --reps 3 --isa all")
+      run(cli .. " pgo-corpus/natural_1024x768_s1.ppm 32 16 --threads 0")
+      os.rmdir("pgo-corpus")
+
+      if _OPTIONS["cc"] == "clang" then
+         run("llvm-profdata merge -output=pgo/default.profdata pgo/*.profraw")
+      end
+      run("make -C build config=pgouse clean")
+      run("make -C build config=pgouse -j4")
+   end
+}
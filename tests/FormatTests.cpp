@@ -0,0 +1,109 @@
+/**
+ * @file FormatTests.cpp
+ * @brief Output format selection: names, extensions, conversions and the
+ *        float images that stay PFM.
+ */
+
+#include <string>
+#include <sstream>
+#include "Image.hpp"
+#include "Test.hpp"
+
+namespace {
+
+/** @brief Magic number image is written with. */
+std::string magicOf(const Image& image) {
+    const std::string bytes = encoded(image);
+    return bytes.substr(0, bytes.compare(0, 4, "qoif") == 0 ? 4 : 2);
+}
+
+Image converted(Image image, Image::Format format) {
+    image.setFormat(format);
+    return image;
+}
+
+} // namespace
+
+TEST(formatNamesParse) {
+    Image::Format format = Image::AsciiFormat;
+    CHECK(Image::parseFormat("binary", format));
+    CHECK_EQ(format, Image::BinaryFormat);
+    CHECK(Image::parseFormat("pam", format));
+    CHECK_EQ(format, Image::PamFormat);
+    CHECK(Image::parseFormat("qoi", format));
+    CHECK_EQ(format, Image::QoiFormat);
+    CHECK(Image::parseFormat("ascii", format));
+    CHECK_EQ(format, Image::AsciiFormat);
+    for (const char* bad : { "", "ASCII", "P7", "pgm", "png", "qoi ", "raw" }) {
+        CHECK(!Image::parseFormat(bad, format));
+        CHECK_EQ(format, Image::AsciiFormat);
+    }
+}
+
+TEST(extensionsFollowFormatAndChannels) {
+    CHECK_EQ(Image::extensionFor(Image::AsciiFormat, 1), ".pgm");
+    CHECK_EQ(Image::extensionFor(Image::AsciiFormat, 3), ".ppm");
+    CHECK_EQ(Image::extensionFor(Image::BinaryFormat, 1), ".pgm");
+    CHECK_EQ(Image::extensionFor(Image::BinaryFormat, 3), ".ppm");
+    // PGM and PPM cannot hold other channel counts
+    CHECK_EQ(Image::extensionFor(Image::AsciiFormat, 2), ".pam");
+    CHECK_EQ(Image::extensionFor(Image::BinaryFormat, 4), ".pam");
+    CHECK_EQ(Image::extensionFor(Image::BinaryFormat, 6), ".pam");
+    CHECK_EQ(Image::extensionFor(Image::PamFormat, 1), ".pam");
+    CHECK_EQ(Image::extensionFor(Image::PamFormat, 3), ".pam");
+    CHECK_EQ(Image::extensionFor(Image::QoiFormat, 3), ".qoi");
+    CHECK_EQ(Image::extensionFor(Image::QoiFormat, 4), ".qoi");
+}
+
+TEST(conversionsPickTheMagicNumber) {
+    const Image gray = noiseImage(4, 3, 1, 255, 1), rgb = noiseImage(4, 3, 3, 255, 2);
+    const Image rgba = noiseImage(4, 3, 4, 255, 3), five = noiseImage(4, 3, 5, 1000, 4);
+    CHECK_EQ(magicOf(converted(gray, Image::BinaryFormat)), "P5");
+    CHECK_EQ(magicOf(converted(converted(gray, Image::BinaryFormat), Image::AsciiFormat)), "P2");
+    CHECK_EQ(magicOf(converted(rgb, Image::BinaryFormat)), "P6");
+    CHECK_EQ(magicOf(converted(rgb, Image::PamFormat)), "P7");
+    CHECK_EQ(magicOf(converted(rgba, Image::AsciiFormat)), "P7");
+    CHECK_EQ(magicOf(converted(five, Image::BinaryFormat)), "P7");
+    CHECK_EQ(magicOf(converted(rgba, Image::QoiFormat)), "qoif");
+    // and back from QOI
+    CHECK_EQ(magicOf(converted(converted(rgb, Image::QoiFormat), Image::BinaryFormat)), "P6");
+    CHECK_EQ(magicOf(converted(converted(rgba, Image::QoiFormat), Image::BinaryFormat)), "P7");
+    const std::string pam = encoded(converted(gray, Image::PamFormat));
+    CHECK(pam.find("TUPLTYPE GRAYSCALE\n") != std::string::npos);
+    // conversions keep every sample
+    std::istringstream in(encoded(converted(five, Image::BinaryFormat)));
+    CHECK_EQ(encoded(Image(in)), encoded(converted(five, Image::BinaryFormat)));
+}
+
+TEST(qoiScalesLowMaxValuesTo255) {
+    std::istringstream in("P2\n3 1\n15\n0 15 7\n");
+    Image image(in);
+    image.setFormat(Image::QoiFormat);
+    CHECK_EQ(image.getMaxValue(), 255);
+    CHECK_EQ(image.rowData(0)[0], 0);
+    CHECK_EQ(image.rowData(0)[1], 255);
+    CHECK_EQ(image.rowData(0)[2], 119);   // 7 * 255 / 15, rounded
+    std::istringstream qoi(encoded(image));
+    const Image decoded(qoi);   // promoted to RGB
+    CHECK_EQ(decoded.rowData(0)[2 * 3], 119);
+
+    Image deep = noiseImage(3, 2, 3, 1000, 5);
+    CHECK_THROWS(deep.setFormat(Image::QoiFormat), "QOI holds up to 4 channels of 8-bit samples");
+    Image wide = noiseImage(3, 2, 5, 255, 6);
+    CHECK_THROWS(wide.convertTo(Image::QoiFormat), "QOI holds up to 4 channels of 8-bit samples");
+}
+
+TEST(floatImagesStayPfm) {
+    const std::string pfm = std::string("Pf\n2 1\n-1\n") + std::string("\0\0\x80\x3f\0\0\0\x40", 8);
+    std::istringstream in(pfm);
+    Image image(in);
+    for (Image::Format format : { Image::AsciiFormat, Image::BinaryFormat, Image::PamFormat,
+                                  Image::QoiFormat }) {
+        CHECK(!image.convertTo(format));
+        CHECK_EQ(encoded(image), pfm);
+        CHECK_THROWS(image.setFormat(format), "Float images can only be written as PFM");
+    }
+    Image gray = noiseImage(2, 2, 1, 255, 7);
+    CHECK(gray.convertTo(Image::BinaryFormat));
+    CHECK_EQ(magicOf(gray), "P5");
+}
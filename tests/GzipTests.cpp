@@ -0,0 +1,185 @@
+/**
+ * @file GzipTests.cpp
+ * @brief InflateBuf against streams from zlib, DeflateBuf round trips and
+ *        the errors of damaged input.
+ */
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include "Gzip.hpp"
+#include "Image.hpp"
+#include "Test.hpp"
+
+namespace {
+
+// zlib, level 9: "seam seam seam carving" in a fixed Huffman block
+const unsigned char kFixed[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x2b, 0x4e,
+    0x4d, 0xcc, 0x55, 0x28, 0x86, 0x13, 0xc9, 0x89, 0x45, 0x65, 0x99, 0x79,
+    0xe9, 0x00, 0xeb, 0x18, 0x63, 0x1b, 0x16, 0x00, 0x00, 0x00
+};
+
+// zlib, level 0: "stored block" in a stored block
+const unsigned char kStored[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x01, 0x0c,
+    0x00, 0xf3, 0xff, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x64, 0x20, 0x62, 0x6c,
+    0x6f, 0x63, 0x6b, 0x94, 0xa3, 0x24, 0x3d, 0x0c, 0x00, 0x00, 0x00
+};
+
+// zlib, level 9: patternText() in a dynamic Huffman block
+const unsigned char kDynamic[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xed, 0xcc,
+    0x31, 0x0e, 0xc0, 0x30, 0x08, 0x04, 0xc1, 0xb7, 0x02, 0x07, 0x9c, 0x31,
+    0xfe, 0x7f, 0x1b, 0x47, 0xca, 0x1b, 0x52, 0xb1, 0xf5, 0x6a, 0x44, 0x44,
+    0x0d, 0xc1, 0x6a, 0x75, 0xb6, 0xe5, 0x36, 0x9e, 0x68, 0xdf, 0xde, 0x21,
+    0x0b, 0x4d, 0x9c, 0x4a, 0x48, 0x17, 0x33, 0x1c, 0x37, 0x8f, 0xbc, 0xaf,
+    0x20, 0xeb, 0x80, 0x8d, 0x25, 0xdf, 0x7c, 0x68, 0x3b, 0xad, 0xe9, 0x7a,
+    0xdf, 0x80, 0xa9, 0xbc, 0x0d, 0x3d, 0xf4, 0xd0, 0x43, 0x0f, 0x3d, 0xf4,
+    0xd0, 0x7f, 0xd0, 0x0f, 0x17, 0x86, 0xc9, 0x13, 0xd0, 0x07, 0x00, 0x00
+};
+
+template <std::size_t N>
+std::string bytes(const unsigned char (&data)[N]) {
+    return std::string(reinterpret_cast<const char*>(data), N);
+}
+
+/** @brief The 2000 bytes compressed in kDynamic. */
+std::string patternText() {
+    std::string text;
+    for (int i = 0; i < 2000; ++i) text.push_back(char(i * i / 7 % 13 + 'a'));
+    return text;
+}
+
+/** @brief Deterministic bytes that do not compress. */
+std::string randomBytes(std::size_t n, unsigned seed) {
+    std::string data(n, '\0');
+    for (auto& c : data) {
+        seed = seed * 1664525u + 1013904223u;
+        c = char(seed >> 24);
+    }
+    return data;
+}
+
+std::string inflate(const std::string& compressed) {
+    std::istringstream src(compressed);
+    InflateBuf buf(src);
+    return std::string(std::istreambuf_iterator<char>(&buf), std::istreambuf_iterator<char>());
+}
+
+std::string deflate(const std::string& data) {
+    std::ostringstream dst;
+    DeflateBuf buf(dst);
+    buf.sputn(data.data(), std::streamsize(data.size()));
+    buf.finish();
+    return dst.str();
+}
+
+/** @brief BTYPE of the first block of a member without optional header fields. */
+int firstBlockType(const std::string& member) { return (member[10] >> 1) & 3; }
+
+} // namespace
+
+TEST(inflateFixedStoredAndDynamicBlocksFromZlib) {
+    CHECK_EQ(firstBlockType(bytes(kFixed)), 1);
+    CHECK_EQ(firstBlockType(bytes(kStored)), 0);
+    CHECK_EQ(firstBlockType(bytes(kDynamic)), 2);
+    CHECK_EQ(inflate(bytes(kFixed)), "seam seam seam carving");
+    CHECK_EQ(inflate(bytes(kStored)), "stored block");
+    CHECK_EQ(inflate(bytes(kDynamic)), patternText());
+}
+
+TEST(inflateSkipsOptionalHeaderFields) {
+    // FNAME and FCOMMENT, as gzip writes for a named file
+    std::string member = bytes(kFixed);
+    member[3] = 0x18;
+    member.insert(10, std::string("t.pgm\0note\0", 11));
+    CHECK_EQ(inflate(member), "seam seam seam carving");
+}
+
+TEST(inflateConcatenatesMembers) {
+    CHECK_EQ(inflate(bytes(kFixed) + bytes(kStored) + bytes(kDynamic)),
+             "seam seam seam carvingstored block" + patternText());
+    CHECK_EQ(inflate(deflate("first ") + deflate("") + deflate("second")), "first second");
+}
+
+TEST(deflateRoundTrips) {
+    std::string text;
+    for (int i = 0; i < 20000; ++i) text += "row " + std::to_string(i % 977) + " of samples\n";
+    const std::vector<std::string> inputs = {
+        "", "x", patternText(), text, randomBytes(150000, 1), encoded(noiseImage(300, 200, 3, 255, 1))
+    };
+    for (const std::string& data : inputs) CHECK(inflate(deflate(data)) == data);
+}
+
+TEST(deflatePicksDynamicOrStoredBlocks) {
+    std::string text;
+    for (int i = 0; i < 5000; ++i) text += "seam " + std::to_string(i % 31) + ' ';
+    const std::string compressed = deflate(text);
+    CHECK_EQ(firstBlockType(compressed), 2);
+    CHECK(compressed.size() < text.size() / 4);
+
+    // incompressible data is stored, at a few bytes of overhead per block
+    const std::string noise = randomBytes(100000, 2);
+    const std::string stored = deflate(noise);
+    CHECK_EQ(firstBlockType(stored), 0);
+    CHECK(stored.size() < noise.size() + 100);
+}
+
+TEST(inflateReportsTruncatedData) {
+    const std::string member = deflate(patternText() + randomBytes(3000, 3));
+    for (std::size_t cut = 1; cut < member.size(); cut += 7)
+        CHECK_THROWS(inflate(member.substr(0, cut)), "Truncated gzip data");
+    CHECK_THROWS(inflate(member.substr(0, member.size() - 1)), "Truncated gzip data");
+}
+
+TEST(inflateReportsCrcAndSizeMismatch) {
+    const std::string member = bytes(kDynamic);
+    for (std::size_t k = member.size() - 8; k < member.size(); ++k) {
+        std::string damaged = member;
+        damaged[k] ^= 0x01;
+        CHECK_THROWS(inflate(damaged), "CRC or size mismatch");
+    }
+}
+
+TEST(inflateRejectsMutatedDataWithAnError) {
+    // any single damaged byte must end in a runtime_error, never in a crash
+    // or undetected corruption; the CRC catches what decodes cleanly
+    const std::string data = encoded(noiseImage(40, 30, 3, 15, 4));
+    const std::string member = deflate(data);
+    unsigned seed = 5;
+    for (int m = 0; m < 300; ++m) {
+        seed = seed * 1664525u + 1013904223u;
+        const std::size_t k = 10 + (seed >> 8) % (member.size() - 10);
+        std::string damaged = member;
+        damaged[k] ^= char(1 + (seed >> 3) % 255);
+        try {
+            CHECK(inflate(damaged) == data);
+        } catch (const TestFailure&) {
+            throw;
+        } catch (const std::runtime_error&) {
+        }
+    }
+}
+
+TEST(gzipDetectionAndNames) {
+    std::istringstream gz(bytes(kFixed)), plain("P2\n1 1\n1\n0\n");
+    CHECK(InflateBuf::detect(gz));
+    CHECK_EQ(gz.tellg(), std::streampos(0));
+    CHECK(!InflateBuf::detect(plain));
+    CHECK(isGzipName("a.ppm.gz"));
+    CHECK(!isGzipName("a.ppm"));
+    CHECK(!isGzipName("gz"));
+}
+
+TEST(imagesRoundTripThroughGzipFiles) {
+    const Image image = noiseImage(31, 17, 3, 255, 6);
+    const std::string name = scratchDir() + "/round_trip.ppm.gz";
+    image.write(name);
+    std::ifstream file(name, std::ios::binary);
+    CHECK(InflateBuf::detect(file));
+    CHECK_EQ(encoded(Image(name)), encoded(image));
+}
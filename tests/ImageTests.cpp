@@ -0,0 +1,126 @@
+/**
+ * @file ImageTests.cpp
+ * @brief Netpbm parsing and writing, and the basic seam carving invariants.
+ */
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstdlib>
+#include <utility>
+#include <algorithm>
+#include "Image.hpp"
+#include "SeamCarver.hpp"
+#include "ThreadPool.hpp"
+#include "Test.hpp"
+
+namespace {
+
+/** @brief Parse text and write it back. */
+std::string roundTrip(const std::string& text) {
+    std::istringstream in(text);
+    return encoded(Image(in));
+}
+
+} // namespace
+
+TEST(asciiImagesWriteBackByteForByte) {
+    const std::string p2 = "P2\n# made by hand\n3 2\n255\n0 1 2 \n3 4 255 \n";
+    const std::string p3 = "P3\n2 1\n65535\n1 2 3 65535 5 6 \n";
+    CHECK_EQ(roundTrip(p2), p2);
+    CHECK_EQ(roundTrip(p3), p3);
+}
+
+TEST(binaryImagesWriteBackByteForByte) {
+    for (int maxValue : { 255, 1000 }) {
+        for (int channels : { 1, 3, 2, 4, 5 }) {
+            Image image = noiseImage(7, 5, channels, maxValue, channels);
+            image.setFormat(Image::BinaryFormat);
+            const std::string bytes = encoded(image);
+            CHECK_EQ(roundTrip(bytes), bytes);
+        }
+    }
+}
+
+TEST(invalidImagesAreRejected) {
+    std::istringstream magic("P4\n1 1\n1\n");
+    CHECK_THROWS(Image{magic}, "Invalid magic");
+    std::istringstream size("P2\n0 3\n255\n");
+    CHECK_THROWS(Image{size}, "Invalid dimensions");
+    std::istringstream sample("P2\n1 1\n15\n16\n");
+    CHECK_THROWS(Image{sample}, "Sample above max value");
+    std::istringstream truncated("P5\n4 4\n255\nabc");
+    CHECK_THROWS(Image{truncated}, "Insufficient pixel data");
+}
+
+TEST(verticalSeamIsConnectedAndRemovesOnePixelPerRow) {
+    const Image image = noiseImage(17, 11, 3, 255, 7);
+    SeamCarver carver(image);
+    const std::vector<int> seam = carver.findVerticalSeam(carver.computeEnergy());
+    CHECK_EQ(int(seam.size()), image.getHeight());
+    for (int i = 0; i < image.getHeight(); ++i) {
+        CHECK(seam[i] >= 0 && seam[i] < image.getWidth());
+        if (i > 0) CHECK(std::abs(seam[i] - seam[i - 1]) <= 1);
+    }
+    carver.removeVerticalSeams(1);
+    const Image result = carver.getResult();
+    CHECK_EQ(result.getWidth(), image.getWidth() - 1);
+    for (int i = 0; i < image.getHeight(); ++i) {
+        const int* src = image.rowData(i);
+        const int* dst = result.rowData(i);
+        for (int j = 0, k = 0; j < image.getWidth(); ++j) {
+            if (j == seam[i]) continue;
+            for (int c = 0; c < 3; ++c) CHECK_EQ(dst[k * 3 + c], src[j * 3 + c]);
+            ++k;
+        }
+    }
+}
+
+namespace {
+
+/**
+ * @brief Carve image single threaded and on a pool of four, optionally in
+ *        strips whose overlap reaches the top row, and require equal output.
+ */
+void checkSameOnPool(const Image& image, int numV, int numH, int strips) {
+    SeamCarver single(image);
+    single.removeVerticalSeams(numV);
+    single.removeHorizontalSeams(numH);
+    ThreadPool pool(4);
+    SeamCarver parallel(image, &pool);
+    if (strips) parallel.setStrips(strips, std::max(image.getWidth(), image.getHeight()));
+    parallel.removeVerticalSeams(numV);
+    parallel.removeHorizontalSeams(numH);
+    const Image a = single.getResult(), b = parallel.getResult();
+    CHECK_EQ(a.getWidth(), image.getWidth() - numV);
+    CHECK_EQ(a.getHeight(), image.getHeight() - numH);
+    CHECK_EQ(encoded(a), encoded(b));
+}
+
+} // namespace
+
+TEST(carvingIsIndependentOfThreadCount) {
+    // at least 128 rows and columns per thread, so all four threads take
+    // column bands and row ranges
+    checkSameOnPool(noiseImage(520, 516, 1, 255, 3), 3, 2, 0);
+    checkSameOnPool(noiseImage(516, 520, 3, 1000, 4), 2, 3, 0);
+}
+
+TEST(stripCarvingOnAPoolIsIndependentOfThreadCount) {
+    checkSameOnPool(noiseImage(520, 516, 3, 255, 5), 3, 2, 4);
+    checkSameOnPool(noiseImage(516, 520, 1, 65535, 6), 2, 3, 7);
+}
+
+TEST(movedInImageCarvesLikeACopy) {
+    const Image image = noiseImage(40, 30, 3, 255, 8);
+    SeamCarver copied(image);
+    Image moved = image;
+    SeamCarver taken(std::move(moved));
+    for (SeamCarver* carver : { &copied, &taken }) {
+        carver->removeVerticalSeams(7);
+        carver->removeHorizontalSeams(5);
+    }
+    const Image result = taken.takeResult();
+    CHECK_EQ(result.getWidth(), 33);
+    CHECK_EQ(encoded(result), encoded(copied.getResult()));
+}
@@ -0,0 +1,91 @@
+/**
+ * @file OutOfCoreTests.cpp
+ * @brief OutOfCoreCarver output against the in-memory SeamCarver.
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include "Image.hpp"
+#include "SeamCarver.hpp"
+#include "OutOfCoreCarver.hpp"
+#include "Test.hpp"
+
+namespace {
+
+std::string readFile(const std::string& name) {
+    std::ifstream in(name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Carve image from a file both ways and require identical output files.
+ */
+void checkSameAsInMemory(const Image& image, int numV, int numH,
+                         const std::vector<int>& energyChannels = {}) {
+    const std::string name = scratchDir() + "/ooc_input" + (image.isColor() ? ".ppm" : ".pgm");
+    image.write(name);
+
+    OutOfCoreCarver outOfCore(name, scratchDir());
+    outOfCore.setEnergyChannels(energyChannels);
+    outOfCore.removeVerticalSeams(numV);
+    outOfCore.removeHorizontalSeams(numH);
+    CHECK_EQ(outOfCore.getWidth(), image.getWidth() - numV);
+    CHECK_EQ(outOfCore.getHeight(), image.getHeight() - numH);
+    outOfCore.write(scratchDir() + "/ooc_output");
+
+    SeamCarver inMemory{Image(name)};
+    inMemory.setEnergyChannels(energyChannels);
+    inMemory.removeVerticalSeams(numV);
+    inMemory.removeHorizontalSeams(numH);
+    inMemory.getResult().write(scratchDir() + "/ooc_reference");
+
+    const std::string reference = readFile(scratchDir() + "/ooc_reference");
+    CHECK(!reference.empty());
+    CHECK(readFile(scratchDir() + "/ooc_output") == reference);
+}
+
+Image binary(Image image) {
+    image.setFormat(Image::BinaryFormat);
+    return image;
+}
+
+} // namespace
+
+TEST(outOfCoreMatchesInMemoryFor8BitImages) {
+    for (int channels : { 1, 3, 4, 5 }) {
+        const Image image = noiseImage(37, 29, channels, 255, channels);
+        checkSameAsInMemory(binary(image), 9, 7);
+        if (channels == 1 || channels == 3) checkSameAsInMemory(image, 9, 7);   // ASCII
+    }
+}
+
+TEST(outOfCoreMatchesInMemoryFor16BitImages) {
+    for (int channels : { 1, 3, 6 }) {
+        const Image image = noiseImage(23, 31, channels, 65535, channels + 10);
+        checkSameAsInMemory(binary(image), 6, 8);
+        if (channels != 6) checkSameAsInMemory(image, 6, 8);
+    }
+}
+
+TEST(outOfCoreMatchesInMemoryForSingleRowsAndColumns) {
+    for (int channels : { 1, 3, 5 }) {
+        checkSameAsInMemory(binary(noiseImage(1, 40, channels, 255, 20 + channels)), 0, 13);
+        checkSameAsInMemory(binary(noiseImage(40, 1, channels, 255, 30 + channels)), 13, 0);
+        checkSameAsInMemory(noiseImage(1, 25, channels, 1000, 40 + channels), 0, 24);
+        checkSameAsInMemory(noiseImage(25, 1, channels, 1000, 50 + channels), 24, 0);
+    }
+}
+
+TEST(outOfCoreMatchesInMemoryWithEnergyChannels) {
+    checkSameAsInMemory(binary(noiseImage(30, 20, 4, 255, 60)), 5, 5, { 0, 1, 2 });
+    checkSameAsInMemory(binary(noiseImage(30, 20, 5, 65535, 61)), 5, 5, { 4 });
+}
+
+TEST(outOfCoreRejectsFloatImages) {
+    const std::string name = scratchDir() + "/ooc_float.pfm";
+    std::ofstream(name, std::ios::binary) << "Pf\n1 1\n-1\n" << std::string(4, '\0');
+    CHECK_THROWS(OutOfCoreCarver(name, scratchDir()), "Float images cannot be carved out of core");
+}
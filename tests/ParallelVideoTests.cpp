@@ -0,0 +1,150 @@
+/**
+ * @file ParallelVideoTests.cpp
+ * @brief ParallelVideoCarver segmentation, and its output against a
+ *        sequential VideoCarver restarted at the same frames.
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <utility>
+#include "Image.hpp"
+#include "ThreadPool.hpp"
+#include "VideoCarver.hpp"
+#include "ParallelVideoCarver.hpp"
+#include "FrameSequence.hpp"
+#include "Y4M.hpp"
+#include "Test.hpp"
+
+namespace {
+
+const int kCut = 7, kFrames = 15;
+
+/**
+ * @brief Frame i of a two-scene clip: dark noise up to frame kCut, bright
+ *        noise after, with the content drifting a little every frame.
+ */
+std::vector<Image> framePlanes(const Y4MHeader& header, int i) {
+    std::vector<Image> planes;
+    for (int p = 0; p < header.planes; ++p) {
+        const Image noise = noiseImage(header.planeWidth(p), header.planeHeight(p), 1, 80, p * 100 + i / 3);
+        Image plane(noise.getWidth(), noise.getHeight(), 1, 255);
+        const int offset = i < kCut ? 0 : 160;
+        for (int r = 0; r < plane.getHeight(); ++r)
+            for (int c = 0; c < plane.getWidth(); ++c)
+                plane.rowData(r)[c] = (noise.rowData(r)[c] + offset + i) % 256;
+        planes.push_back(std::move(plane));
+    }
+    return planes;
+}
+
+std::string readFile(const std::string& name) {
+    std::ifstream in(name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/** @brief Write the clip as a Y4M file and return its name. */
+std::string writeClip(const Y4MHeader& header) {
+    const std::string name = scratchDir() + "/clip.y4m";
+    std::ofstream out(name, std::ios::binary);
+    Y4MWriter writer(out, header);
+    for (int i = 0; i < kFrames; ++i) writer.write(framePlanes(header, i));
+    return name;
+}
+
+/**
+ * @brief The clip carved front to back by one VideoCarver that restarts
+ *        with a full search at each segment start.
+ */
+std::string carveSequentially(const Y4MHeader& header, int numV, int numH, int keyframe,
+                              const std::vector<ParallelVideoCarver::Segment>& segments) {
+    Y4MHeader outHeader = header;
+    outHeader.width -= numV;
+    outHeader.height -= numH;
+    std::ostringstream out;
+    Y4MWriter writer(out, outHeader);
+    VideoCarver carver(numV, numH);
+    carver.setKeyframeInterval(keyframe);
+    carver.setSceneCutThreshold(0);
+    std::size_t next = 0;
+    for (int i = 0; i < kFrames; ++i) {
+        if (next < segments.size() && segments[next].first == i) {
+            carver.reset();
+            ++next;
+        }
+        writer.write(carveY4MFrame(carver, header, framePlanes(header, i)));
+    }
+    return out.str();
+}
+
+} // namespace
+
+TEST(segmentsSplitAtSceneCuts) {
+    const Y4MHeader header = Y4MHeader::parse(" W48 H36 C420");
+    const std::string clip = writeClip(header);
+    ThreadPool pool(3);
+    ParallelVideoCarver carver(5, 3, pool);
+    CHECK_EQ(carver.carveY4M(clip, scratchDir() + "/clip_out.y4m"), kFrames);
+    const std::vector<ParallelVideoCarver::Segment>& segments = carver.segments();
+    CHECK_EQ(int(segments.size()), 2);
+    CHECK_EQ(segments[0].first, 0);
+    CHECK_EQ(segments[0].count, kCut);
+    CHECK_EQ(segments[1].first, kCut);
+    CHECK_EQ(segments[1].count, kFrames - kCut);
+
+    // without detection, only the length limit splits
+    carver.setSceneCutThreshold(0);
+    carver.setMaxSegment(4);
+    carver.carveY4M(clip, scratchDir() + "/clip_out.y4m");
+    CHECK_EQ(int(carver.segments().size()), 4);
+    for (std::size_t s = 0; s < carver.segments().size(); ++s) {
+        CHECK_EQ(carver.segments()[s].first, (long long)s * 4);
+        CHECK_EQ(carver.segments()[s].count, s < 3 ? 4 : kFrames - 12);
+    }
+
+    // with both, scenes are cut first and then split
+    carver.setSceneCutThreshold(0.35);
+    carver.setMaxSegment(3);
+    carver.carveY4M(clip, scratchDir() + "/clip_out.y4m");
+    const long long expected[][2] = { { 0, 3 }, { 3, 3 }, { 6, 1 }, { 7, 3 }, { 10, 3 }, { 13, 2 } };
+    CHECK_EQ(int(carver.segments().size()), 6);
+    for (int s = 0; s < 6; ++s) {
+        CHECK_EQ(carver.segments()[s].first, expected[s][0]);
+        CHECK_EQ(carver.segments()[s].count, expected[s][1]);
+    }
+}
+
+TEST(segmentedY4MMatchesSequentialCarving) {
+    for (const char* colour : { "C420", "C444", "Cmono" }) {
+        const Y4MHeader header = Y4MHeader::parse(" W48 H36 " + std::string(colour));
+        const std::string clip = writeClip(header), out = scratchDir() + "/clip_out.y4m";
+        for (int maxSegment : { 0, 3 }) {
+            ThreadPool pool(3);
+            ParallelVideoCarver carver(6, 4, pool);
+            carver.setKeyframeInterval(2);
+            carver.setMaxSegment(maxSegment);
+            carver.carveY4M(clip, out);
+            CHECK_EQ(readFile(out), carveSequentially(header, 6, 4, 2, carver.segments()));
+        }
+    }
+}
+
+TEST(segmentedFramesMatchSequentialCarving) {
+    const Y4MHeader header = Y4MHeader::parse(" W48 H36 Cmono");
+    const FramePattern in(scratchDir() + "/clip_%03d.pgm"), out(scratchDir() + "/clip_out_%03d.pgm");
+    for (int i = 0; i < kFrames; ++i) framePlanes(header, i)[0].write(in.name(i + 1));
+    ThreadPool pool(4);
+    ParallelVideoCarver carver(7, 2, pool);
+    CHECK_EQ(carver.carveFrames(scratchDir() + "/clip_%03d.pgm", scratchDir() + "/clip_out_%03d.pgm", 1),
+             kFrames);
+    CHECK_EQ(int(carver.segments().size()), 2);
+
+    VideoCarver sequential(7, 2);
+    sequential.setSceneCutThreshold(0);
+    for (int i = 0; i < kFrames; ++i) {
+        if (i == kCut) sequential.reset();
+        CHECK_EQ(readFile(out.name(i + 1)), encoded(sequential.carve(Image(in.name(i + 1)))));
+    }
+}
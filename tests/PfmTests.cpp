@@ -0,0 +1,101 @@
+/**
+ * @file PfmTests.cpp
+ * @brief PFM byte order and row order, and float carving on every kernel table.
+ */
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstdint>
+#include <cstring>
+#include "Image.hpp"
+#include "SeamCarver.hpp"
+#include "Kernels.hpp"
+#include "Test.hpp"
+
+namespace {
+
+/**
+ * @brief A PFM file: header, then rows in file order (bottom row first) in
+ *        the byte order the sign of scale gives.
+ */
+std::string pfm(const std::string& magic, int width, int height, const std::string& scale,
+                const std::vector<float>& samples) {
+    std::string s = magic + "\n" + std::to_string(width) + " " + std::to_string(height)
+                  + "\n" + scale + "\n";
+    const bool little = scale[0] == '-';
+    for (float f : samples) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &f, 4);
+        for (int byte = 0; byte < 4; ++byte) s += char(bits >> 8 * (little ? byte : 3 - byte));
+    }
+    return s;
+}
+
+/** @brief Deterministic float samples with fractions, negatives and large values. */
+std::vector<float> floatNoise(std::size_t count, unsigned seed) {
+    std::vector<float> samples(count);
+    unsigned x = seed * 2654435761u + 1;
+    for (float& f : samples) {
+        x = x * 1664525u + 1013904223u;
+        f = float(int(x >> 8) % 20000 - 2000) / 64.0f;
+    }
+    return samples;
+}
+
+} // namespace
+
+TEST(pfmRoundTripsInBothByteOrders) {
+    for (const char* magic : { "Pf", "PF" }) {
+        const int channels = magic[1] == 'F' ? 3 : 1;
+        for (const char* scale : { "-1", "1", "-0.5", "2.5" }) {
+            const std::string bytes = pfm(magic, 5, 3, scale, floatNoise(5 * 3 * channels, channels));
+            std::istringstream in(bytes);
+            const Image image(in);
+            CHECK(image.isFloat());
+            CHECK_EQ(image.getChannels(), channels);
+            CHECK_EQ(encoded(image), bytes);
+        }
+    }
+}
+
+TEST(pfmRowsRunBottomToTop) {
+    const std::vector<float> samples = { 1.5f, -2.0f, 3.25f, 4.0f, 5.0f, -6.5f };
+    for (const char* scale : { "-1", "1" }) {
+        std::istringstream in(pfm("Pf", 3, 2, scale, samples));
+        const Image image(in);
+        // the first row in the file is the bottom of the image
+        CHECK_EQ(sampleFloat(image.rowData(1)[0]), 1.5f);
+        CHECK_EQ(sampleFloat(image.rowData(1)[2]), 3.25f);
+        CHECK_EQ(sampleFloat(image.rowData(0)[0]), 4.0f);
+        CHECK_EQ(sampleFloat(image.rowData(0)[2]), -6.5f);
+    }
+    std::istringstream truncated(pfm("PF", 3, 2, "-1", samples));
+    CHECK_THROWS(Image{truncated}, "Insufficient pixel data");
+}
+
+TEST(floatCarvingIsTheSameOnEveryKernelTable) {
+    const Kernels::Isa initial = Kernels::active();
+    for (int channels : { 1, 3 }) {
+        std::istringstream in(pfm(channels == 3 ? "PF" : "Pf", 71, 53, "-1",
+                                  floatNoise(71 * 53 * channels, 20 + channels)));
+        const Image image(in);
+        std::string reference;
+        for (int isa = Kernels::Baseline; isa <= Kernels::detect(); ++isa) {
+            CHECK(Kernels::select(Kernels::Isa(isa)));
+            SeamCarver carver(image);
+            carver.removeVerticalSeams(11);
+            carver.removeHorizontalSeams(9);
+            const std::string result = encoded(carver.getResult());
+            if (isa == Kernels::Baseline) reference = result;
+            CHECK_EQ(result, reference);
+        }
+    }
+    Kernels::select(initial);
+}
+
+TEST(floatImagesHaveNoIntegerEnergy) {
+    std::istringstream in(pfm("Pf", 4, 4, "-1", floatNoise(16, 1)));
+    SeamCarver carver{Image(in)};
+    CHECK_THROWS(carver.computeEnergy(), "Float images have float energies");
+}
@@ -0,0 +1,75 @@
+/**
+ * @file PnmTests.cpp
+ * @brief PAM header parsing and energy channel ranges.
+ */
+
+#include <string>
+#include <sstream>
+#include "Pnm.hpp"
+#include "Image.hpp"
+#include "SeamCarver.hpp"
+#include "OutOfCoreCarver.hpp"
+#include "Test.hpp"
+
+TEST(pamHeaderFieldsComeInAnyOrder) {
+    std::istringstream in("P7\nTUPLTYPE RGB_ALPHA\nMAXVAL 1000\nDEPTH 4\nHEIGHT 2\nWIDTH 3\nENDHDR\nX");
+    const PnmHeader h = PnmHeader::read(in);
+    CHECK_EQ(h.magic, "P7");
+    CHECK_EQ(h.width, 3);
+    CHECK_EQ(h.height, 2);
+    CHECK_EQ(h.depth, 4);
+    CHECK_EQ(h.channels(), 4);
+    CHECK_EQ(h.maxValue, 1000);
+    CHECK_EQ(h.tupleType, "RGB_ALPHA");
+    CHECK(h.hasAlpha());
+    // left at the first sample
+    CHECK_EQ(in.get(), 'X');
+}
+
+TEST(pamHeaderKeepsCommentsAndJoinsTupleTypes) {
+    std::istringstream in("P7\n# first\nWIDTH 2\n\n# second\r\nHEIGHT 1\r\nDEPTH 2\n"
+                          "TUPLTYPE GRAYSCALE\nTUPLTYPE _ALPHA\nMAXVAL 255\nENDHDR\n");
+    const PnmHeader h = PnmHeader::read(in);
+    CHECK_EQ(int(h.comments.size()), 2);
+    CHECK_EQ(h.comments[0], "# first");
+    CHECK_EQ(h.comments[1], "# second");
+    CHECK_EQ(h.height, 1);
+    CHECK_EQ(h.tupleType, "GRAYSCALE _ALPHA");
+    std::ostringstream out;
+    h.write(out);
+    CHECK_EQ(out.str(), "P7\n# first\n# second\nWIDTH 2\nHEIGHT 1\nDEPTH 2\nMAXVAL 255\n"
+                        "TUPLTYPE GRAYSCALE _ALPHA\nENDHDR\n");
+}
+
+TEST(pamHeaderRejectsInvalidHeaders) {
+    const std::string body = "WIDTH 2\nHEIGHT 2\n";
+    std::istringstream noEnd("P7\n" + body + "DEPTH 1\nMAXVAL 255\n");
+    CHECK_THROWS(PnmHeader::read(noEnd), "Truncated PAM header");
+    std::istringstream noDepth("P7\n" + body + "DEPTH 0\nMAXVAL 255\nENDHDR\n");
+    CHECK_THROWS(PnmHeader::read(noDepth), "Invalid dimensions, depth or max value");
+    std::istringstream missingDepth("P7\n" + body + "MAXVAL 255\nENDHDR\n");
+    CHECK_THROWS(PnmHeader::read(missingDepth), "Invalid dimensions, depth or max value");
+    std::istringstream wide("P7\n" + body + "DEPTH 1\nMAXVAL 65536\nENDHDR\n");
+    CHECK_THROWS(PnmHeader::read(wide), "Invalid dimensions, depth or max value");
+    std::istringstream unknown("P7\n" + body + "DEPTH 1\nCOLOURS 3\nMAXVAL 255\nENDHDR\n");
+    CHECK_THROWS(PnmHeader::read(unknown), "Invalid PAM header line: COLOURS 3");
+    std::istringstream noValue("P7\nWIDTH\nHEIGHT 2\nDEPTH 1\nMAXVAL 255\nENDHDR\n");
+    CHECK_THROWS(PnmHeader::read(noValue), "Invalid PAM header line");
+}
+
+TEST(energyChannelsMustExist) {
+    const Image rgba = noiseImage(6, 5, 4, 255, 3);
+    SeamCarver carver(rgba);
+    CHECK_THROWS(carver.setEnergyChannels({ 0, 4 }), "Energy channel out of range");
+    CHECK_THROWS(carver.setEnergyChannels({ -1 }), "Energy channel out of range");
+    carver.setEnergyChannels({ 3 });
+
+    Image binary = rgba;
+    binary.setFormat(Image::BinaryFormat);
+    const std::string name = scratchDir() + "/channels.pam";
+    binary.write(name);
+    OutOfCoreCarver outOfCore(name, scratchDir());
+    CHECK_THROWS(outOfCore.setEnergyChannels({ 1, 2, 7 }), "Energy channel out of range");
+    CHECK_THROWS(outOfCore.setEnergyChannels({ -2 }), "Energy channel out of range");
+    outOfCore.setEnergyChannels({ 0, 1, 2, 3 });
+}
@@ -0,0 +1,155 @@
+/**
+ * @file QoiTests.cpp
+ * @brief QoiCodec chunk encoding against the specification, round trips and
+ *        the decoder's handling of what follows the end marker.
+ */
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include "Qoi.hpp"
+#include "Image.hpp"
+#include "Test.hpp"
+
+namespace {
+
+const std::string kEndMarker("\0\0\0\0\0\0\0\1", 8);
+
+QoiHeader headerFor(int width, int height, int channels) {
+    QoiHeader header;
+    header.width = width;
+    header.height = height;
+    header.channels = channels;
+    return header;
+}
+
+/** @brief Chunk bytes of pixels, without the header and end marker. */
+std::string chunks(const std::vector<int>& pixels, int width, int channels, int headerChannels) {
+    std::ostringstream out;
+    const QoiHeader header = headerFor(width, int(pixels.size()) / channels / width, headerChannels);
+    QoiCodec::encode(out, header, pixels.data(), channels);
+    const std::string all = out.str();
+    CHECK_EQ(all.substr(all.size() - 8), kEndMarker);
+    return all.substr(14, all.size() - 14 - 8);
+}
+
+std::vector<int> decode(const std::string& chunkBytes, int width, int height, int channels) {
+    std::ostringstream header;
+    headerFor(width, height, channels).write(header);
+    std::istringstream in(header.str() + chunkBytes + kEndMarker);
+    const QoiHeader parsed = QoiHeader::read(in);
+    std::vector<int> pixels(std::size_t(width) * height * channels);
+    QoiCodec::decode(in, parsed, pixels.data());
+    return pixels;
+}
+
+std::string hex(const std::string& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    std::string s;
+    for (unsigned char b : bytes) {
+        s += digits[b >> 4];
+        s += digits[b & 15];
+    }
+    return s;
+}
+
+} // namespace
+
+TEST(qoiEncodesEveryOpAsSpecified) {
+    const std::vector<int> pixels = {
+        0, 0, 0, 255,         // same as the implicit previous pixel: RUN 1
+        1, 1, 1, 255,         // +1 in every channel: DIFF
+        11, 10, 9, 255,       // green +9, red and blue within 8 of it: LUMA
+        200, 50, 0, 255,      // too far: RGB
+        1, 1, 1, 255,         // seen before, hash 4: INDEX
+        1, 1, 1, 128,         // new alpha: RGBA
+    };
+    const std::string expected = "c0" "7f" "a997" "fec83200" "04" "ff01010180";
+    const std::string encoded = chunks(pixels, 6, 4, 4);
+    CHECK_EQ(hex(encoded), expected);
+    CHECK(decode(encoded, 6, 1, 4) == pixels);
+}
+
+TEST(qoiSplitsRunsAt62) {
+    const std::vector<int> black130(130 * 3, 0), black62(62 * 3, 0);
+    CHECK_EQ(hex(chunks(black130, 130, 3, 3)), "fdfdc5");
+    CHECK_EQ(hex(chunks(black62, 62, 3, 3)), "fd");
+    CHECK(decode(chunks(black130, 130, 3, 3), 13, 10, 3) == black130);
+
+    // a run that reaches 62 in the middle of the image restarts cleanly
+    std::vector<int> pixels(64 * 3, 0);
+    pixels[189] = 7; pixels[190] = 7; pixels[191] = 9;
+    const std::string encoded = chunks(pixels, 64, 3, 3);
+    CHECK_EQ(hex(encoded), "fdc0" "a78a");
+    CHECK(decode(encoded, 8, 8, 3) == pixels);
+}
+
+TEST(qoiPromotesGrayToRgb) {
+    const std::vector<int> gray = { 0, 17, 255, 17 };
+    std::vector<int> rgb;
+    for (int g : gray) rgb.insert(rgb.end(), { g, g, g });
+    CHECK_EQ(chunks(gray, 2, 1, 3), chunks(rgb, 2, 3, 3));
+
+    const std::vector<int> grayAlpha = { 0, 255, 17, 3, 255, 0, 17, 3 };
+    std::vector<int> rgba;
+    for (std::size_t k = 0; k < grayAlpha.size(); k += 2)
+        rgba.insert(rgba.end(), { grayAlpha[k], grayAlpha[k], grayAlpha[k], grayAlpha[k + 1] });
+    CHECK_EQ(chunks(grayAlpha, 2, 2, 4), chunks(rgba, 2, 4, 4));
+    CHECK(decode(chunks(grayAlpha, 2, 2, 4), 2, 2, 4) == rgba);
+}
+
+TEST(qoiRejectsWhatItCannotHold) {
+    const std::vector<int> gray = { 0, 256 }, pixel = { 1, 2 };
+    std::ostringstream out;
+    CHECK_THROWS(QoiCodec::encode(out, headerFor(2, 1, 3), gray.data(), 1), "at most 255");
+    CHECK_THROWS(QoiCodec::encode(out, headerFor(1, 1, 3), pixel.data(), 2), "RGB or RGBA");
+    std::istringstream badChannels(std::string("qoif\0\0\0\1\0\0\0\1\2\0", 14));
+    CHECK_THROWS(QoiHeader::read(badChannels), "channels or colorspace");
+    std::istringstream truncated(std::string("qoif\0\0\0\1", 8));
+    CHECK_THROWS(QoiHeader::read(truncated), "Truncated QOI header");
+}
+
+TEST(qoiReportsTruncatedDataAndMissingEndMarker) {
+    const Image image = noiseImage(20, 10, 3, 255, 1);
+    Image qoi = image;
+    qoi.setFormat(Image::QoiFormat);
+    const std::string bytes = encoded(qoi);
+    std::istringstream cut(bytes.substr(0, bytes.size() / 2));
+    CHECK_THROWS(Image{cut}, "Truncated QOI data");
+    std::string noMarker = bytes;
+    noMarker.back() = 0;
+    std::istringstream bad(noMarker);
+    CHECK_THROWS(Image{bad}, "Missing QOI end marker");
+}
+
+TEST(qoiRoundTripsImages) {
+    for (int channels : { 3, 4 }) {
+        // noise (RGB/RGBA and INDEX ops) next to a smooth ramp (DIFF, LUMA, RUN)
+        Image image = noiseImage(97, 61, channels, 255, channels);
+        for (int r = 30; r < 61; ++r) {
+            int* row = image.rowData(r);
+            for (int k = 0; k < 97 * channels; ++k) row[k] = (r + k / channels / 3) % 256;
+        }
+        image.setFormat(Image::QoiFormat);
+        std::istringstream in(encoded(image));
+        const Image decoded(in);
+        CHECK_EQ(decoded.getChannels(), channels);
+        CHECK_EQ(encoded(decoded), encoded(image));
+        for (int r = 0; r < 61; ++r)
+            for (int k = 0; k < 97 * channels; ++k) CHECK_EQ(decoded.rowData(r)[k], image.rowData(r)[k]);
+    }
+}
+
+TEST(qoiDecodeStopsAtTheEndMarker) {
+    // concatenated streams parse one image at a time
+    Image first = noiseImage(9, 7, 4, 255, 2), second = noiseImage(1, 300, 3, 255, 3);
+    first.setFormat(Image::QoiFormat);
+    second.setFormat(Image::QoiFormat);
+    const std::string a = encoded(first), b = encoded(second), tail = "P2\n1 1\n9\n4\n";
+    std::istringstream in(a + b + tail);
+    CHECK_EQ(encoded(Image(in)), a);
+    CHECK_EQ(std::size_t(in.tellg()), a.size());
+    CHECK_EQ(encoded(Image(in)), b);
+    CHECK_EQ(std::size_t(in.tellg()), a.size() + b.size());
+    CHECK_EQ(encoded(Image(in)), "P2\n1 1\n9\n4 \n");
+}
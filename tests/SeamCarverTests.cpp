@@ -0,0 +1,183 @@
+/**
+ * @file SeamCarverTests.cpp
+ * @brief SeamCarver search options: strip-parallel search, cost types and
+ *        the gray plane.
+ */
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "Image.hpp"
+#include "SeamCarver.hpp"
+#include "ThreadPool.hpp"
+#include "Test.hpp"
+
+namespace {
+
+/** @brief Every seam spans its image's rows, stays inside it and is 8-connected. */
+void checkConnected(const std::vector<std::vector<int>>& seams, int rows, int cols) {
+    for (std::size_t k = 0; k < seams.size(); ++k) {
+        const std::vector<int>& seam = seams[k];
+        CHECK_EQ(int(seam.size()), rows);
+        for (int i = 0; i < rows; ++i) {
+            CHECK(seam[i] >= 0 && seam[i] < cols - int(k));
+            if (i > 0) CHECK(std::abs(seam[i] - seam[i - 1]) <= 1);
+        }
+    }
+}
+
+/**
+ * @brief Carve image on a pool in strips and check the recorded seams, and
+ *        that the result keeps exactly the pixels those seams leave.
+ * @return The carved image.
+ */
+Image carveInStrips(const Image& image, int numV, int numH, int strips, int overlap,
+                    ThreadPool* pool) {
+    SeamCarver::History history;
+    SeamCarver carver(image, pool);
+    carver.setStrips(strips, overlap);
+    carver.recordSeams(&history);
+    carver.removeVerticalSeams(numV);
+    carver.removeHorizontalSeams(numH);
+    const int w = image.getWidth(), h = image.getHeight(), C = image.getChannels();
+    checkConnected(history.vertical, h, w);
+    checkConnected(history.horizontal, w - numV, h);
+
+    const Image result = carver.getResult();
+    CHECK_EQ(result.getWidth(), w - numV);
+    CHECK_EQ(result.getHeight(), h - numH);
+    const Image map = SeamCarver::survivorMap(w, h, history);
+    for (int i = 0; i < result.getHeight(); ++i) {
+        for (int j = 0; j < result.getWidth(); ++j) {
+            const int index = map.rowData(i)[j];
+            for (int c = 0; c < C; ++c)
+                CHECK_EQ(result.rowData(i)[j * C + c], image.rowData(index / w)[index % w * C + c]);
+        }
+    }
+    return result;
+}
+
+/** @brief The exact single threaded result. */
+Image carveExactly(const Image& image, int numV, int numH) {
+    SeamCarver carver(image);
+    carver.removeVerticalSeams(numV);
+    carver.removeHorizontalSeams(numH);
+    return carver.getResult();
+}
+
+} // namespace
+
+TEST(stripSeamsAreConnectedAndRemoveOnePixelPerRow) {
+    ThreadPool pool(4);
+    for (int strips : { 2, 4, 9 }) {
+        for (int overlap : { 0, 3, 16 })
+            carveInStrips(noiseImage(61, 90, 3, 255, strips + overlap), 7, 5, strips, overlap, &pool);
+    }
+    carveInStrips(noiseImage(40, 50, 1, 65535, 1), 6, 6, 5, 2, &pool);
+}
+
+TEST(stripsOverlappingEveryRowMatchTheExactSearch) {
+    ThreadPool pool(3);
+    for (int channels : { 1, 3 }) {
+        const Image image = noiseImage(57, 64, channels, 255, 10 + channels);
+        const Image striped = carveInStrips(image, 6, 4, 4, 64, &pool);
+        CHECK_EQ(encoded(striped), encoded(carveExactly(image, 6, 4)));
+    }
+}
+
+TEST(stripsFallBackToTheExactSearch) {
+    const Image image = noiseImage(45, 20, 3, 255, 12);
+    const std::string exact = encoded(carveExactly(image, 5, 0));
+    ThreadPool pool(4);
+    // fewer than two rows per strip
+    CHECK_EQ(encoded(carveInStrips(image, 5, 0, 11, 0, &pool)), exact);
+    // no pool to run the strips on
+    CHECK_EQ(encoded(carveInStrips(image, 5, 0, 4, 0, nullptr)), exact);
+    // one strip is the exact search
+    CHECK_EQ(encoded(carveInStrips(image, 5, 0, 1, 0, &pool)), exact);
+}
+
+TEST(autoCostWidensExactlyWhere32BitsCouldOverflow) {
+    // (height + 1) * 4 * maxValue must stay within INT_MAX / 2 = 1073741823
+    CHECK_EQ(SeamCarver::costTypeFor(SeamCarver::AutoCost, 4095, 65535), SeamCarver::Cost32);
+    CHECK_EQ(SeamCarver::costTypeFor(SeamCarver::AutoCost, 4096, 65535), SeamCarver::Cost64);
+    CHECK_EQ(SeamCarver::costTypeFor(SeamCarver::AutoCost, 1052687, 255), SeamCarver::Cost32);
+    CHECK_EQ(SeamCarver::costTypeFor(SeamCarver::AutoCost, 1052688, 255), SeamCarver::Cost64);
+    CHECK_EQ(SeamCarver::costTypeFor(SeamCarver::Cost32, 4095, 65535), SeamCarver::Cost32);
+    CHECK_THROWS(SeamCarver::costTypeFor(SeamCarver::Cost32, 4096, 65535), "overflow 32 bits");
+    CHECK_EQ(SeamCarver::costTypeFor(SeamCarver::Cost64, 2, 1), SeamCarver::Cost64);
+}
+
+TEST(cost32RefusesTallSixteenBitImages) {
+    const Image tall = noiseImage(4, 4100, 1, 65535, 13);
+    SeamCarver carver(tall);
+    carver.setCostType(SeamCarver::Cost32);
+    CHECK_THROWS(carver.removeVerticalSeams(1), "overflow 32 bits");
+    // horizontal seams run over the 4 columns and fit
+    SeamCarver across(tall);
+    across.setCostType(SeamCarver::Cost32);
+    across.removeHorizontalSeams(1);
+    CHECK_EQ(across.getResult().getHeight(), 4099);
+}
+
+TEST(costTypesAgreeWhereBothFit) {
+    for (int maxValue : { 255, 65535 }) {
+        const Image image = noiseImage(47, 38, 3, maxValue, 14);
+        std::string results[3];
+        const SeamCarver::CostType types[3] = { SeamCarver::AutoCost, SeamCarver::Cost32,
+                                                SeamCarver::Cost64 };
+        for (int t = 0; t < 3; ++t) {
+            SeamCarver carver(image);
+            carver.setCostType(types[t]);
+            carver.removeVerticalSeams(8);
+            carver.removeHorizontalSeams(6);
+            results[t] = encoded(carver.getResult());
+        }
+        CHECK_EQ(results[0], results[1]);
+        CHECK_EQ(results[0], results[2]);
+    }
+}
+
+TEST(costTypeNamesParse) {
+    SeamCarver::CostType type = SeamCarver::Cost64;
+    CHECK(SeamCarver::parseCostType("auto", type));
+    CHECK_EQ(type, SeamCarver::AutoCost);
+    CHECK(SeamCarver::parseCostType("32", type));
+    CHECK_EQ(type, SeamCarver::Cost32);
+    CHECK(SeamCarver::parseCostType("64", type));
+    CHECK_EQ(type, SeamCarver::Cost64);
+    for (const char* bad : { "", "16", "Auto", "AUTO", "64 ", " 32", "32bit", "0" }) {
+        CHECK(!SeamCarver::parseCostType(bad, type));
+        CHECK_EQ(type, SeamCarver::Cost64);
+    }
+}
+
+TEST(grayPlaneCarvesLikeTheImageRows) {
+    ThreadPool pool(2);
+    for (int maxValue : { 255, 65535 }) {
+        for (int channels : { 3, 4 }) {
+            const Image image = noiseImage(300, 260, channels, maxValue, 15 + channels);
+            std::string results[2];
+            for (int plane = 0; plane < 2; ++plane) {
+                SeamCarver carver(image, &pool);
+                carver.setGrayPlane(plane == 1);
+                carver.removeVerticalSeams(9);
+                carver.removeHorizontalSeams(7);
+                results[plane] = encoded(carver.getResult());
+            }
+            CHECK_EQ(results[0], results[1]);
+        }
+    }
+    // a channel subset goes through the plane too
+    const Image rgba = noiseImage(64, 48, 4, 65535, 19);
+    std::string results[2];
+    for (int plane = 0; plane < 2; ++plane) {
+        SeamCarver carver(rgba);
+        carver.setEnergyChannels({ 0, 1, 2 });
+        carver.setGrayPlane(plane == 1);
+        carver.removeVerticalSeams(5);
+        carver.removeHorizontalSeams(5);
+        results[plane] = encoded(carver.getResult());
+    }
+    CHECK_EQ(results[0], results[1]);
+}
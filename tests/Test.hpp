@@ -0,0 +1,78 @@
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "Image.hpp"
+
+#ifndef TESTS_TEST_HPP
+#define TESTS_TEST_HPP
+
+/**
+ * @brief Thrown by a failed check; the runner reports it and carries on
+ *        with the next test.
+ */
+class TestFailure : public std::runtime_error {
+public:
+    explicit TestFailure(const std::string& message) : std::runtime_error(message) {}
+};
+
+/** @brief A named test function, registered by the TEST macro. */
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+/** @brief Every test linked into the executable, in registration order. */
+std::vector<TestCase>& testRegistry();
+
+/** @brief Adds a test to the registry during static initialization. */
+struct TestRegistrar {
+    TestRegistrar(const char* name, void (*run)()) { testRegistry().push_back({ name, run }); }
+};
+
+/** @brief Throw a TestFailure naming the location of the failed check. */
+[[noreturn]] void failCheck(const char* file, int line, const std::string& what);
+
+/**
+ * @brief Image of deterministic noise with samples in 0..maxValue.
+ * @param channels 1 and 3 give P2/P3, anything else P7, like Image's constructor.
+ */
+Image noiseImage(int width, int height, int channels, int maxValue, unsigned seed);
+
+/** @brief Bytes image.write() produces. */
+std::string encoded(const Image& image);
+
+/** @brief Directory for the files a test writes, created on first use. */
+std::string scratchDir();
+
+#define TEST(name)                                                   \
+    static void name();                                              \
+    static TestRegistrar name##Registrar(#name, &name);              \
+    static void name()
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) failCheck(__FILE__, __LINE__, "CHECK(" #cond ")"); \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                               \
+    do {                                                             \
+        if (!((a) == (b))) failCheck(__FILE__, __LINE__, "CHECK_EQ(" #a ", " #b ")"); \
+    } while (0)
+
+// expr must throw a runtime_error whose message contains text
+#define CHECK_THROWS(expr, text)                                     \
+    do {                                                             \
+        bool thrown = false;                                         \
+        try {                                                        \
+            expr;                                                    \
+        } catch (const TestFailure&) {                               \
+            throw;                                                   \
+        } catch (const std::runtime_error& e) {                      \
+            thrown = true;                                           \
+            if (std::string(e.what()).find(text) == std::string::npos) \
+                failCheck(__FILE__, __LINE__, std::string("unexpected error: ") + e.what()); \
+        }                                                            \
+        if (!thrown) failCheck(__FILE__, __LINE__, "no error from " #expr); \
+    } while (0)
+
+#endif // !TESTS_TEST_HPP
@@ -0,0 +1,33 @@
+/**
+ * @file VideoTests.cpp
+ * @brief VideoCarver's band search and its profiler accounting.
+ */
+
+#include <string>
+#include "Image.hpp"
+#include "Profiler.hpp"
+#include "VideoCarver.hpp"
+#include "Test.hpp"
+
+TEST(bandSearchCountsOnlyTheBandsPixels) {
+    const int width = 120, height = 40, seams = 5, radius = 4;
+    const Image frame = noiseImage(width, height, 1, 255, 11);
+    Profiler profiler;
+    VideoCarver carver(seams, 0);
+    carver.setBand(radius);
+    carver.setProfiler(&profiler);
+
+    // the first frame is a full search over the shrinking width
+    carver.carve(frame);
+    long long full = 0;
+    for (int s = 0; s < seams; ++s) full += (long long)(width - s) * height;
+    CHECK_EQ(profiler.pixels(Profiler::Energy), full);
+    CHECK_EQ(profiler.pixels(Profiler::Forward), full);
+
+    // the next one only searches within radius of each previous seam
+    carver.carve(frame);
+    const long long banded = profiler.pixels(Profiler::Energy) - full;
+    CHECK(banded > 0);
+    CHECK(banded <= (long long)seams * height * (2 * radius + 1));
+    CHECK_EQ(profiler.pixels(Profiler::Forward) - full, banded);
+}
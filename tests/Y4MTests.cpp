@@ -0,0 +1,168 @@
+/**
+ * @file Y4MTests.cpp
+ * @brief YUV4MPEG2 header parsing, frame I/O and the carving of chroma
+ *        planes along the luma seams.
+ */
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include "Image.hpp"
+#include "VideoCarver.hpp"
+#include "Y4M.hpp"
+#include "Test.hpp"
+
+namespace {
+
+struct ColourSpace {
+    const char* tags;
+    int planes, subX, subY, bits;
+};
+
+} // namespace
+
+TEST(y4mParsesColourSpaces) {
+    const ColourSpace cases[] = {
+        { " W4 H2", 3, 2, 2, 8 },
+        { " W4 H2 C420jpeg", 3, 2, 2, 8 },
+        { " W4 H2 C420paldv", 3, 2, 2, 8 },
+        { " W4 H2 C420mpeg2", 3, 2, 2, 8 },
+        { " W4 H2 C420", 3, 2, 2, 8 },
+        { " W4 H2 C420p10", 3, 2, 2, 10 },
+        { " W4 H2 C420p16", 3, 2, 2, 16 },
+        { " W4 H2 C422", 3, 2, 1, 8 },
+        { " W4 H2 C422p12", 3, 2, 1, 12 },
+        { " W4 H2 C411", 3, 4, 1, 8 },
+        { " W4 H2 C444", 3, 1, 1, 8 },
+        { " W4 H2 C444p10", 3, 1, 1, 10 },
+        { " W4 H2 C444alpha", 4, 1, 1, 8 },
+        { " W4 H2 Cmono", 1, 2, 2, 8 },
+        { " W4 H2 Cmono16", 1, 2, 2, 16 },
+    };
+    for (const ColourSpace& c : cases) {
+        const Y4MHeader h = Y4MHeader::parse(c.tags);
+        CHECK_EQ(h.width, 4);
+        CHECK_EQ(h.height, 2);
+        CHECK_EQ(h.planes, c.planes);
+        CHECK_EQ(h.subX, c.subX);
+        CHECK_EQ(h.subY, c.subY);
+        CHECK_EQ(h.bits, c.bits);
+    }
+}
+
+TEST(y4mRejectsUnsupportedHeaders) {
+    CHECK_THROWS(Y4MHeader::parse(" W4 H2 C420p7"), "Unsupported Y4M colour space");
+    CHECK_THROWS(Y4MHeader::parse(" W4 H2 C420p17"), "Unsupported Y4M colour space");
+    CHECK_THROWS(Y4MHeader::parse(" W4 H2 C444x"), "Unsupported Y4M colour space");
+    CHECK_THROWS(Y4MHeader::parse(" W4 H2 Cyuv"), "Unsupported Y4M colour space");
+    CHECK_THROWS(Y4MHeader::parse(" H2 C420"), "without frame size");
+    std::istringstream notY4M("P5\n1 1\n255\n");
+    CHECK_THROWS(Y4MReader{notY4M}, "expected YUV4MPEG2");
+}
+
+TEST(y4mKeepsOtherTagsAndSizesPlanes) {
+    const Y4MHeader h = Y4MHeader::parse(" W5 H3 F30000:1001 Ip A1:1 C420p10 XYSCSS=420P10");
+    CHECK_EQ(h.str(), "YUV4MPEG2 W5 H3 F30000:1001 Ip A1:1 C420p10 XYSCSS=420P10");
+    CHECK_EQ(h.planeWidth(0), 5);
+    CHECK_EQ(h.planeHeight(0), 3);
+    CHECK_EQ(h.planeWidth(1), 3);
+    CHECK_EQ(h.planeHeight(2), 2);
+    CHECK_EQ(h.frameBytes(), (15 + 6 + 6) * 2);
+    const Y4MHeader w = Y4MHeader::parse(" W5 H3 C411");
+    CHECK_EQ(w.planeWidth(1), 2);
+    CHECK_EQ(w.planeHeight(1), 3);
+}
+
+TEST(y4mReadsAndWritesLittleEndianSamples) {
+    const std::string header = "YUV4MPEG2 W3 H2 C444p16\n";
+    std::string frame = "FRAME\n";
+    for (int k = 0; k < 3 * 6; ++k) {
+        const int v = (0x1234 + 0x0f01 * k) & 0xffff;
+        frame += char(v & 0xff);
+        frame += char(v >> 8);
+    }
+    std::istringstream in(header + frame + frame);
+    Y4MReader reader(in);
+    std::vector<Image> planes;
+    CHECK(reader.next(planes));
+    CHECK_EQ(int(planes.size()), 3);
+    CHECK_EQ(planes[0].getMaxValue(), 65535);
+    CHECK_EQ(planes[0].rowData(0)[0], 0x1234);
+    CHECK_EQ(planes[0].rowData(0)[1], 0x1234 + 0x0f01);
+    CHECK_EQ(planes[2].rowData(1)[2], (0x1234 + 0x0f01 * 17) & 0xffff);
+
+    std::ostringstream out;
+    Y4MWriter writer(out, reader.header());
+    writer.write(planes);
+    CHECK(reader.next(planes));
+    writer.write(planes);
+    CHECK(!reader.next(planes));
+    CHECK(out.str() == header + frame + frame);
+
+    // 10 and 12 bit samples must fit their depth
+    for (const char* colour : { "C444p10", "C444p12" }) {
+        std::string bad = "FRAME\n" + std::string(3 * 6 * 2, '\0');
+        bad[6 + 2 * 5 + 1] = char(0x10);
+        std::istringstream high("YUV4MPEG2 W3 H2 " + std::string(colour) + "\n" + bad);
+        Y4MReader deep(high);
+        CHECK_THROWS(deep.next(planes), "Y4M sample above max value");
+    }
+    std::istringstream fits("YUV4MPEG2 W3 H2 C444p12\nFRAME\n" + std::string(3 * 6 * 2, '\x0f'));
+    Y4MReader twelve(fits);
+    CHECK(twelve.next(planes));
+    CHECK_EQ(planes[1].rowData(1)[2], 0x0f0f);
+
+    std::istringstream truncated(header + frame.substr(0, frame.size() - 1));
+    Y4MReader cut(truncated);
+    CHECK_THROWS(cut.next(planes), "Truncated Y4M frame");
+}
+
+TEST(y4mChromaFollowsTheSurvivingLumaPixels) {
+    // luma = position * kScale + noise, so every carved luma sample names
+    // the original pixel it came from
+    const int width = 23, height = 17, numV = 6, numH = 4, kScale = 160;
+    for (const char* colour : { "C420p16", "C422p16", "C411p16", "C444p16", "C444alpha", "Cmono16" }) {
+        const Y4MHeader header = Y4MHeader::parse(" W23 H17 " + std::string(colour));
+        const int maxValue = (1 << header.bits) - 1;
+        std::vector<Image> planes;
+        const Image noise = noiseImage(width, height, 1, kScale - 1, 9);
+        Image luma(width, height, 1, maxValue);
+        for (int r = 0; r < height; ++r)
+            for (int c = 0; c < width; ++c)
+                luma.rowData(r)[c] = header.bits == 8 ? noise.rowData(r)[c]
+                                                      : (r * width + c) * kScale + noise.rowData(r)[c];
+        planes.push_back(luma);
+        for (int p = 1; p < header.planes; ++p) {
+            const int w = header.planeWidth(p), h = header.planeHeight(p);
+            Image plane(w, h, 1, maxValue);
+            for (int i = 0; i < h; ++i)
+                for (int j = 0; j < w; ++j) plane.rowData(i)[j] = (p * 31 + i * w + j) % (maxValue + 1);
+            // full size 8-bit planes copy the luma, so they must come out equal to it
+            planes.push_back(header.bits == 8 ? luma : plane);
+        }
+
+        VideoCarver carver(numV, numH);
+        const std::vector<Image> out = carveY4MFrame(carver, header, planes);
+        CHECK_EQ(int(out.size()), header.planes);
+        const int outW = width - numV, outH = height - numH;
+        CHECK_EQ(out[0].getWidth(), outW);
+        CHECK_EQ(out[0].getHeight(), outH);
+        if (header.bits == 8) {
+            // 444alpha: every plane loses exactly the luma seams
+            for (int p = 1; p < header.planes; ++p) CHECK_EQ(encoded(out[p]), encoded(out[0]));
+            continue;
+        }
+        for (int p = 1; p < header.planes; ++p) {
+            const int sx = header.subX, sy = header.subY;
+            CHECK_EQ(out[p].getWidth(), (outW + sx - 1) / sx);
+            CHECK_EQ(out[p].getHeight(), (outH + sy - 1) / sy);
+            for (int i = 0; i < out[p].getHeight(); ++i) {
+                for (int j = 0; j < out[p].getWidth(); ++j) {
+                    const int origin = out[0].rowData(i * sy)[j * sx] / kScale;
+                    const int r = origin / width, c = origin % width;
+                    CHECK_EQ(out[p].rowData(i)[j], planes[p].rowData(r / sy)[c / sx]);
+                }
+            }
+        }
+    }
+}
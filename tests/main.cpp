@@ -0,0 +1,72 @@
+/**
+ * @file main.cpp
+ * @brief Test runner for the seamcarve library.
+ *
+ * Usage: seamcarve-tests [FILTER]
+ *   Runs every test whose name contains FILTER (all tests by default),
+ *   prints one line per failure and a summary, and exits non-zero if any
+ *   test failed.
+ */
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+#include <exception>
+#include <cstdlib>
+#include "Test.hpp"
+
+std::vector<TestCase>& testRegistry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+void failCheck(const char* file, int line, const std::string& what) {
+    throw TestFailure(std::string(file) + ":" + std::to_string(line) + ": " + what);
+}
+
+Image noiseImage(int width, int height, int channels, int maxValue, unsigned seed) {
+    Image image(width, height, channels, maxValue);
+    unsigned state = seed * 2654435761u + 1;
+    for (int r = 0; r < height; ++r) {
+        int* row = image.rowData(r);
+        for (int k = 0; k < width * channels; ++k) {
+            state = state * 1664525u + 1013904223u;
+            row[k] = int((state >> 8) % unsigned(maxValue + 1));
+        }
+    }
+    return image;
+}
+
+std::string encoded(const Image& image) {
+    std::ostringstream out;
+    image.write(out);
+    return out.str();
+}
+
+std::string scratchDir() {
+    static const std::string dir = [] {
+        auto path = std::filesystem::temp_directory_path() / "seamcarve-tests";
+        std::filesystem::create_directories(path);
+        return path.string();
+    }();
+    return dir;
+}
+
+int main(int argc, char* argv[]) {
+    const std::string filter = argc > 1 ? argv[1] : "";
+    int run = 0, failed = 0;
+    for (const TestCase& test : testRegistry()) {
+        if (std::string(test.name).find(filter) == std::string::npos) continue;
+        ++run;
+        try {
+            test.run();
+        } catch (const std::exception& e) {
+            ++failed;
+            std::cerr << "FAIL " << test.name << ": " << e.what() << "\n";
+        }
+    }
+    std::cout << run - failed << "/" << run << " tests passed\n";
+    return failed == 0 && run > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}